@@ -0,0 +1,208 @@
+#include "ahocorasick.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include <QQueue>
+
+/**
+ * @brief Feeds the code units of a text to a visitor, case-folded if the automaton is case-insensitive.
+ *
+ * Surrogate pairs are folded as one code point, then passed on as two units. The
+ * visitor returns false to stop early.
+ */
+template <typename Visitor>
+void AhoCorasick::forEachUnit(const QStringView text, Visitor visit) const
+{
+    const qsizetype length = text.size();
+    for (qsizetype i = 0; i < length; ++i) {
+        const QChar c = text[i];
+        if (m_CaseSensitive) {
+            if (!visit(c.unicode())) {
+                return;
+            }
+        }
+        else if (c.isHighSurrogate() && i + 1 < length && text[i + 1].isLowSurrogate()) {
+            const char32_t folded = QChar::toCaseFolded(QChar::surrogateToUcs4(c, text[i + 1]));
+            const bool goOn = QChar::requiresSurrogates(folded)
+                ? visit(QChar::highSurrogate(folded)) && visit(QChar::lowSurrogate(folded))
+                : visit(static_cast<char16_t>(folded));
+            if (!goOn) {
+                return;
+            }
+            ++i;
+        }
+        else if (!visit(c.toCaseFolded().unicode())) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Builds the automaton for a set of patterns.
+ *
+ * @param patterns The patterns; an empty pattern is present in every text.
+ * @param cs Whether the patterns are matched case-sensitively.
+ */
+AhoCorasick::AhoCorasick(const QStringList& patterns, const Qt::CaseSensitivity cs)
+    : m_PatternCount(patterns.size())
+    , m_Words((patterns.size() + 63) / 64)
+    , m_CaseSensitive(cs == Qt::CaseSensitive)
+{
+    m_All.fill(0, m_Words);
+    addState();
+
+    /*****************
+     * 1. Build trie *
+     *****************/
+
+    for (const qsizetype i : std::views::iota(qsizetype(0), patterns.size())) {
+        int state = 0;
+        forEachUnit(patterns.at(i), [&](const char16_t unit) {
+            int next = -1;
+            if (unit < asciiSize) {
+                next = m_Ascii.at(state * asciiSize + unit);
+            }
+            else {
+                for (const auto& [edge, target] : std::as_const(m_Wide.at(state))) {
+                    if (edge == unit) {
+                        next = target;
+                    }
+                }
+            }
+
+            if (next < 0) {
+                next = addState();
+                if (unit < asciiSize) {
+                    m_Ascii[state * asciiSize + unit] = next;
+                }
+                else {
+                    m_Wide[state].push_back({ unit, next });
+                }
+            }
+            state = next;
+            return true;
+        });
+
+        m_Output[state * m_Words + i / 64] |= quint64(1) << (i % 64);
+        m_HasOutput[state] = true;
+        m_All[i / 64] |= quint64(1) << (i % 64);
+    }
+
+    /***************************************************************
+     * 2. Compute failure links and complete the ASCII transitions *
+     ***************************************************************/
+
+    QQueue<int> queue;
+    queue.enqueue(0);
+
+    while (!queue.isEmpty()) {
+        const int state = queue.dequeue();
+        const int fail = m_Fail.at(state);
+
+        const auto reach = [&](const int child, const int failTarget) {
+            m_Fail[child] = state == 0 ? 0 : failTarget;
+            for (const qsizetype w : std::views::iota(qsizetype(0), m_Words)) {
+                m_Output[child * m_Words + w] |= m_Output.at(m_Fail.at(child) * m_Words + w);
+            }
+            m_HasOutput[child] = m_HasOutput.at(child) || m_HasOutput.at(m_Fail.at(child));
+            queue.enqueue(child);
+        };
+
+        for (const int unit : std::views::iota(0, asciiSize)) {
+            const int child = m_Ascii.at(state * asciiSize + unit);
+            const int failTransition = state == 0 ? 0 : m_Ascii.at(fail * asciiSize + unit);
+            if (child < 0) {
+                m_Ascii[state * asciiSize + unit] = failTransition;
+            }
+            else {
+                reach(child, failTransition);
+            }
+        }
+
+        for (const auto& [unit, child] : std::as_const(m_Wide.at(state))) {
+            reach(child, state == 0 ? 0 : wideTransition(fail, unit));
+        }
+    }
+}
+
+/**
+ * @brief Scans a text and marks the patterns that occur in it.
+ *
+ * @param text The text to be scanned.
+ * @param present Receives the pattern bitmask; must hold wordCount() words, which are overwritten.
+ */
+void AhoCorasick::scan(const QStringView text, quint64* present) const
+{
+    std::copy_n(m_Output.constData(), m_Words, present);
+    if (m_PatternCount == 0 || coversAll(present)) {
+        return;
+    }
+
+    int state = 0;
+    forEachUnit(text, [&](const char16_t unit) {
+        state = unit < asciiSize ? m_Ascii.at(state * asciiSize + unit) : wideTransition(state, unit);
+        if (!m_HasOutput.at(state)) {
+            return true;
+        }
+        const quint64* output = m_Output.constData() + state * m_Words;
+        for (const qsizetype w : std::views::iota(qsizetype(0), m_Words)) {
+            present[w] |= output[w];
+        }
+        // once every pattern has been seen the rest of the text cannot change the result
+        return !coversAll(present);
+    });
+}
+
+qsizetype AhoCorasick::patternCount() const
+{
+    return m_PatternCount;
+}
+
+qsizetype AhoCorasick::wordCount() const
+{
+    return m_Words;
+}
+
+int AhoCorasick::addState()
+{
+    const int state = static_cast<int>(m_Fail.size());
+    m_Ascii.insert(m_Ascii.size(), asciiSize, -1);
+    m_Wide.push_back({});
+    m_Fail.push_back(0);
+    m_Output.insert(m_Output.size(), m_Words, 0);
+    m_HasOutput.push_back(false);
+    return state;
+}
+
+/**
+ * @brief Follows a non-ASCII code unit, falling back along failure links.
+ *
+ * @param state The current state.
+ * @param unit The (case-folded) code unit.
+ * @return int The next state.
+ */
+int AhoCorasick::wideTransition(int state, const char16_t unit) const
+{
+    while (true) {
+        for (const auto& [edge, target] : m_Wide.at(state)) {
+            if (edge == unit) {
+                return target;
+            }
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = m_Fail.at(state);
+    }
+}
+
+bool AhoCorasick::coversAll(const quint64* present) const
+{
+    for (const qsizetype w : std::views::iota(qsizetype(0), m_Words)) {
+        if ((present[w] & m_All.at(w)) != m_All.at(w)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @brief Aho-Corasick automaton reporting which of a set of patterns occur in a text.
+ *
+ * A text is scanned once, whatever the number of patterns, and the result is a
+ * bitmask with one bit per pattern (in the order they were given), stored in
+ * wordCount() 64-bit words. Transitions on ASCII code units are resolved into
+ * a dense table; other code units follow sparse edges and failure links.
+ *
+ * Case-insensitive automata compare simple case foldings, as QString::contains()
+ * does with Qt::CaseInsensitive.
+ */
+class AhoCorasick
+{
+public:
+    AhoCorasick() = default;
+    AhoCorasick(const QStringList& patterns, Qt::CaseSensitivity cs);
+
+    void scan(QStringView text, quint64* present) const;
+
+    qsizetype patternCount() const;
+    qsizetype wordCount() const;
+
+private:
+    static constexpr int asciiSize = 128;
+
+    int addState();
+    int wideTransition(int state, char16_t unit) const;
+    bool coversAll(const quint64* present) const;
+
+    template <typename Visitor>
+    void forEachUnit(QStringView text, Visitor visit) const;
+
+    QList<int> m_Ascii;
+    QList<QList<QPair<char16_t, int>>> m_Wide;
+    QList<int> m_Fail;
+    QList<quint64> m_Output;
+    QList<bool> m_HasOutput;
+    QList<quint64> m_All;
+    qsizetype m_PatternCount = 0;
+    qsizetype m_Words = 0;
+    bool m_CaseSensitive = true;
+};
@@ -0,0 +1,251 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtGlobal>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+    constexpr int baselineVersion = 1;
+    constexpr double megabyte = 1024.0 * 1024.0;
+
+    double percentChange(const double value, const double reference)
+    {
+        return reference != 0 ? (value - reference) * 100.0 / reference : 0.0;
+    }
+} // namespace
+
+/********************
+ * StageMeasurement *
+ ********************/
+
+StageMeasurement::StageMeasurement(const QString& stage, const QString& corpus)
+    : m_Stage(stage)
+    , m_Corpus(corpus)
+{}
+
+void StageMeasurement::startOperation()
+{
+    m_Clock.start();
+}
+
+/**
+ * @brief Records the operation started last.
+ *
+ * @param items The prompts, instances or queries it processed.
+ * @param bytes The bytes it read or wrote.
+ */
+void StageMeasurement::endOperation(const qint64 items, const qint64 bytes)
+{
+    const qint64 nsecs = m_Clock.nsecsElapsed();
+    m_Latencies.push_back(nsecs);
+    m_Nsecs += nsecs;
+    m_Items += items;
+    m_Bytes += bytes;
+    m_PeakRss = peakResidentSetSize();
+}
+
+const QString& StageMeasurement::stage() const
+{
+    return m_Stage;
+}
+
+const QString& StageMeasurement::corpus() const
+{
+    return m_Corpus;
+}
+
+double StageMeasurement::itemsPerSecond() const
+{
+    return m_Nsecs > 0 ? m_Items * 1e9 / m_Nsecs : 0.0;
+}
+
+double StageMeasurement::megabytesPerSecond() const
+{
+    return m_Nsecs > 0 ? m_Bytes / megabyte * 1e9 / m_Nsecs : 0.0;
+}
+
+/**
+ * @brief The latency of an operation at the given percentile, by the nearest-rank method.
+ *
+ * @param percentile The percentile, from 0 to 100.
+ */
+double StageMeasurement::latencyMsecs(const double percentile) const
+{
+    if (m_Latencies.isEmpty()) {
+        return 0.0;
+    }
+    QList<qint64> sorted = m_Latencies;
+    std::ranges::sort(sorted);
+    const auto rank = static_cast<qsizetype>(std::ceil(percentile / 100.0 * sorted.size()));
+    return sorted.at(std::clamp<qsizetype>(rank - 1, 0, sorted.size() - 1)) / 1e6;
+}
+
+/**
+ * @brief The peak resident set size of the process when the last operation ended.
+ */
+qint64 StageMeasurement::peakRss() const
+{
+    return m_PeakRss;
+}
+
+StageSummary StageSummary::of(const StageMeasurement& measurement)
+{
+    return { measurement.stage(),
+             measurement.corpus(),
+             measurement.itemsPerSecond(),
+             measurement.megabytesPerSecond(),
+             measurement.latencyMsecs(50),
+             measurement.latencyMsecs(99),
+             measurement.peakRss() / megabyte };
+}
+
+/***********
+ * Helpers *
+ ***********/
+
+/**
+ * @brief The largest resident set size the process has had so far, in bytes; 0 where unknown.
+ */
+qint64 peakResidentSetSize()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#elif defined(Q_OS_UNIX)
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(Q_OS_DARWIN)
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+    // in KiB everywhere but on Apple platforms
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void printSummaries(const QList<StageSummary>& summaries)
+{
+    std::printf("%-12s %-12s %14s %10s %10s %10s %10s\n", "stage", "corpus", "items/s", "MB/s", "p50 ms", "p99 ms", "peak MB");
+    for (const StageSummary& summary : summaries) {
+        std::printf("%-12s %-12s %14.0f %10.1f %10.3f %10.3f %10.1f\n",
+                    qPrintable(summary.stage), qPrintable(summary.corpus), summary.itemsPerSecond,
+                    summary.megabytesPerSecond, summary.p50Msecs, summary.p99Msecs, summary.peakRssMegabytes);
+    }
+}
+
+/**
+ * @brief Saves the summaries of a run, to compare later runs with.
+ *
+ * @return bool False if the file could not be written.
+ */
+bool saveBaseline(const QString& fileName, const QList<StageSummary>& summaries)
+{
+    QJsonArray stages;
+    for (const StageSummary& summary : summaries) {
+        QJsonObject stage;
+        stage["stage"] = summary.stage;
+        stage["corpus"] = summary.corpus;
+        stage["items_per_second"] = summary.itemsPerSecond;
+        stage["megabytes_per_second"] = summary.megabytesPerSecond;
+        stage["p50_ms"] = summary.p50Msecs;
+        stage["p99_ms"] = summary.p99Msecs;
+        stage["peak_rss_mb"] = summary.peakRssMegabytes;
+        stages.push_back(stage);
+    }
+    QJsonObject baseline;
+    baseline["version"] = baselineVersion;
+    baseline["stages"] = stages;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(baseline).toJson());
+    return file.commit();
+}
+
+/**
+ * @brief Reads the summaries saved by saveBaseline().
+ *
+ * @return bool False if the file could not be read or has another format.
+ */
+bool loadBaseline(const QString& fileName, QList<StageSummary>& summaries)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+    if (baseline["version"].toInt() != baselineVersion) {
+        return false;
+    }
+
+    summaries.clear();
+    for (const auto& value : baseline["stages"].toArray()) {
+        const QJsonObject stage = value.toObject();
+        summaries.push_back({ stage["stage"].toString(),
+                              stage["corpus"].toString(),
+                              stage["items_per_second"].toDouble(),
+                              stage["megabytes_per_second"].toDouble(),
+                              stage["p50_ms"].toDouble(),
+                              stage["p99_ms"].toDouble(),
+                              stage["peak_rss_mb"].toDouble() });
+    }
+    return true;
+}
+
+/**
+ * @brief Prints the changes from a baseline, for the stages and corpora measured in both.
+ *
+ * A stage regressed when its throughput dropped, or its p99 latency grew, by
+ * more than the tolerance.
+ *
+ * @param tolerancePercent The change tolerated, in percent, e.g. to absorb noise.
+ * @return int The number of stages that regressed.
+ */
+int compareWithBaseline(const QList<StageSummary>& summaries, const QList<StageSummary>& baseline, const double tolerancePercent)
+{
+    std::printf("%-12s %-12s %12s %12s %12s\n", "stage", "corpus", "items/s", "p99", "peak RSS");
+
+    int regressions = 0;
+    for (const StageSummary& summary : summaries) {
+        const auto reference = std::ranges::find_if(baseline, [&](const StageSummary& other) {
+            return other.stage == summary.stage && other.corpus == summary.corpus;
+        });
+        if (reference == baseline.cend()) {
+            continue;
+        }
+
+        const double throughput = percentChange(summary.itemsPerSecond, reference->itemsPerSecond);
+        const double p99 = percentChange(summary.p99Msecs, reference->p99Msecs);
+        const double rss = percentChange(summary.peakRssMegabytes, reference->peakRssMegabytes);
+        const bool regressed = throughput < -tolerancePercent || p99 > tolerancePercent;
+        regressions += regressed ? 1 : 0;
+
+        std::printf("%-12s %-12s %+11.1f%% %+11.1f%% %+11.1f%%%s\n",
+                    qPrintable(summary.stage), qPrintable(summary.corpus), throughput, p99, rss,
+                    regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
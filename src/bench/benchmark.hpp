@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The measurements of one pipeline stage on one corpus.
+ *
+ * A stage is timed as a whole and per operation, e.g. per dataset read or per
+ * query compiled; the operation latencies give the percentiles.
+ */
+class StageMeasurement
+{
+public:
+    StageMeasurement(const QString& stage, const QString& corpus);
+
+    void startOperation();
+    void endOperation(qint64 items, qint64 bytes);
+
+    const QString& stage() const;
+    const QString& corpus() const;
+    double itemsPerSecond() const;
+    double megabytesPerSecond() const;
+    double latencyMsecs(double percentile) const;
+    qint64 peakRss() const;
+
+private:
+    QString m_Stage;
+    QString m_Corpus;
+    QElapsedTimer m_Clock;
+    qint64 m_Items = 0;
+    qint64 m_Bytes = 0;
+    qint64 m_Nsecs = 0;
+    QList<qint64> m_Latencies;
+    qint64 m_PeakRss = 0;
+};
+
+/**
+ * @brief The summary of a stage measurement, as saved in a baseline file.
+ */
+struct StageSummary {
+    QString stage;
+    QString corpus;
+    double itemsPerSecond = 0;
+    double megabytesPerSecond = 0;
+    double p50Msecs = 0;
+    double p99Msecs = 0;
+    double peakRssMegabytes = 0;
+
+    static StageSummary of(const StageMeasurement& measurement);
+};
+
+qint64 peakResidentSetSize();
+
+void printSummaries(const QList<StageSummary>& summaries);
+bool saveBaseline(const QString& fileName, const QList<StageSummary>& summaries);
+bool loadBaseline(const QString& fileName, QList<StageSummary>& summaries);
+int compareWithBaseline(const QList<StageSummary>& summaries, const QList<StageSummary>& baseline, double tolerancePercent);
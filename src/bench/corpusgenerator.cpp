@@ -0,0 +1,223 @@
+#include "corpusgenerator.hpp"
+
+#include <algorithm>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "languagemodel.hpp"
+
+namespace {
+    // instances are handed to the file whenever the buffer grows past this size
+    constexpr qsizetype flushThreshold = 1024 * 1024;
+
+    QString datasetName(const int dataset)
+    {
+        return QString("synthetic:subject=s%1").arg(dataset);
+    }
+} // namespace
+
+/**
+ * @brief A short name for the corpus size, e.g. `10x1000` for 10 datasets of 1000 instances.
+ */
+QString CorpusSpec::label() const
+{
+    return QString("%1x%2").arg(datasets).arg(instancesPerDataset);
+}
+
+CorpusGenerator::CorpusGenerator(const CorpusSpec& spec)
+    : m_Spec(spec)
+{}
+
+/**
+ * @brief Writes the corpus, replacing the files of a previous one with the same datasets.
+ *
+ * @param helmDataPath The HELM data root to create.
+ * @param helmTestsFile The `helm_tests.json` file to write; empty to skip it.
+ * @return bool False if a file could not be written; see errorString().
+ */
+bool CorpusGenerator::write(const QString& helmDataPath, const QString& helmTestsFile)
+{
+    m_Error.clear();
+    const int modelCount = std::clamp(m_Spec.modelsPerDataset, 1, static_cast<int>(HPB::Models.size()));
+
+    for (int dataset = 0; dataset < m_Spec.datasets; ++dataset) {
+        // every dataset has its own stream, so its instances do not depend on the dataset count
+        m_Random.seed(m_Spec.seed + static_cast<quint32>(dataset));
+
+        QStringList runDirs;
+        for (int model = 0; model < modelCount; ++model) {
+            runDirs.push_back(QDir(helmDataPath).filePath(datasetName(dataset) + ",model=" + HPB::Models.at(model).name()));
+            if (!QDir().mkpath(runDirs.last())) {
+                m_Error = "Failed to create " + runDirs.last();
+                return false;
+            }
+
+            QJsonObject adapterSpec;
+            adapterSpec["model"] = QString::fromLatin1(HPB::Models.at(model).name());
+            QJsonObject runSpec;
+            runSpec["name"] = QDir(runDirs.last()).dirName();
+            runSpec["adapter_spec"] = adapterSpec;
+            QFile runSpecFile(runDirs.last() + "/run_spec.json");
+            if (!runSpecFile.open(QIODevice::WriteOnly) || runSpecFile.write(QJsonDocument(runSpec).toJson()) < 0) {
+                m_Error = "Failed to write " + runSpecFile.fileName();
+                return false;
+            }
+        }
+
+        // the instances are generated once, into the first run directory, and copied to the others
+        QFile instances(runDirs.first() + "/instances.json");
+        if (!instances.open(QIODevice::WriteOnly)) {
+            m_Error = "Failed to write " + instances.fileName() + ": " + instances.errorString();
+            return false;
+        }
+        QByteArray buffer = "[\n";
+        for (int i = 0; i < m_Spec.instancesPerDataset; ++i) {
+            const bool perturbed = m_Random.generateDouble() < m_Spec.perturbedFraction;
+            buffer += instance(i, false);
+            if (perturbed) {
+                buffer += ",\n";
+                buffer += instance(i, true);
+            }
+            buffer += i + 1 < m_Spec.instancesPerDataset ? ",\n" : "\n";
+            if (buffer.size() >= flushThreshold) {
+                instances.write(buffer);
+                buffer.resize(0);
+            }
+        }
+        buffer += "]\n";
+        if (instances.write(buffer) < 0 || !instances.flush()) {
+            m_Error = "Failed to write " + instances.fileName() + ": " + instances.errorString();
+            return false;
+        }
+        instances.close();
+
+        for (const QString& runDir : runDirs.sliced(1)) {
+            QFile::remove(runDir + "/instances.json");
+            if (!QFile::copy(instances.fileName(), runDir + "/instances.json")) {
+                m_Error = "Failed to write " + runDir + "/instances.json";
+                return false;
+            }
+        }
+    }
+
+    if (helmTestsFile.isEmpty()) {
+        return true;
+    }
+
+    QJsonArray tests;
+    for (const QString& dataset : datasets()) {
+        QJsonObject test;
+        test["name"] = dataset;
+        test["metric"] = "exact_match";
+        test["split"] = "test";
+        tests.push_back(test);
+    }
+    QJsonObject config;
+    config["synthetic"] = tests;
+    QFile file(helmTestsFile);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(config).toJson()) < 0) {
+        m_Error = "Failed to write " + helmTestsFile;
+        return false;
+    }
+    return true;
+}
+
+QString CorpusGenerator::errorString() const
+{
+    return m_Error;
+}
+
+/**
+ * @brief The names of the datasets of the corpus, in order.
+ */
+QStringList CorpusGenerator::datasets() const
+{
+    QStringList names;
+    names.reserve(m_Spec.datasets);
+    for (int dataset = 0; dataset < m_Spec.datasets; ++dataset) {
+        names.push_back(datasetName(dataset));
+    }
+    return names;
+}
+
+/**
+ * @brief The words prompts are made of: every combination of three of 16 syllables.
+ */
+const QStringList& CorpusGenerator::vocabulary()
+{
+    static const QStringList syllableWords = [] {
+        static constexpr const char* syllables[] = { "ka", "lo", "mi", "ne", "ru", "ta", "vo", "zi",
+                                                     "be", "do", "fu", "ga", "hi", "ju", "pe", "so" };
+        QStringList list;
+        for (const char* first : syllables) {
+            for (const char* second : syllables) {
+                for (const char* third : syllables) {
+                    list.push_back(QString::fromLatin1(first) + second + third);
+                }
+            }
+        }
+        return list;
+    }();
+    return syllableWords;
+}
+
+/***********
+ * Helpers *
+ ***********/
+
+/**
+ * @brief Generates one instance, as a compact JSON object.
+ *
+ * A perturbed instance shares the id of the one it follows, as in HELM; its
+ * text is drawn anew.
+ */
+QByteArray CorpusGenerator::instance(const int index, const bool perturbed)
+{
+    const int promptWords = std::max(1, m_Spec.promptWords);
+    const int wordCount = std::max(1, promptWords / 2) + m_Random.bounded(promptWords + 1);
+
+    QJsonObject input;
+    input["text"] = words(wordCount);
+
+    QJsonArray references;
+    const int correct = m_Spec.referencesPerInstance > 0 ? m_Random.bounded(m_Spec.referencesPerInstance) : -1;
+    for (int i = 0; i < m_Spec.referencesPerInstance; ++i) {
+        QJsonObject output;
+        output["text"] = words(1 + m_Random.bounded(8));
+        QJsonObject reference;
+        reference["output"] = output;
+        reference["tags"] = i == correct ? QJsonArray{ "correct" } : QJsonArray();
+        references.push_back(reference);
+    }
+
+    QJsonObject object;
+    object["input"] = input;
+    object["references"] = references;
+    object["split"] = "test";
+    object["id"] = QString("id%1").arg(index);
+    if (perturbed) {
+        QJsonObject perturbation;
+        perturbation["name"] = "synonym";
+        perturbation["prob"] = 0.5;
+        object["perturbation"] = perturbation;
+    }
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+QString CorpusGenerator::words(const int count)
+{
+    const QStringList& vocabulary = CorpusGenerator::vocabulary();
+    QString text;
+    text.reserve(count * 7);
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += vocabulary.at(static_cast<qsizetype>(m_Random.bounded(static_cast<quint32>(vocabulary.size()))));
+    }
+    return text;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The shape of a synthetic HELM corpus.
+ */
+struct CorpusSpec {
+    int datasets = 10;
+    int instancesPerDataset = 1000;
+    int promptWords = 120;          // mean prompt length; actual lengths vary by up to half of it
+    int referencesPerInstance = 4;
+    double perturbedFraction = 0.2; // share of instances followed by a perturbed copy
+    int modelsPerDataset = 1;
+    quint32 seed = 1;
+
+    QString label() const;
+};
+
+/**
+ * @brief Writes a synthetic HELM data root, for benchmarks and profiling.
+ *
+ * Each dataset is `synthetic:subject=sN`, evaluated on the first models of
+ * HPB::Models: one run directory per model, with an `instances.json` and a
+ * `run_spec.json` laid out as HELM writes them. A `helm_tests.json` listing
+ * every dataset can be written along with them, for exports.
+ *
+ * Prompts are drawn uniformly from a fixed vocabulary of pseudo-words, so that a
+ * query for one word matches a predictable share of them: about promptWords /
+ * vocabulary().size(). The same spec and seed always produce the same corpus.
+ */
+class CorpusGenerator
+{
+public:
+    explicit CorpusGenerator(const CorpusSpec& spec);
+
+    bool write(const QString& helmDataPath, const QString& helmTestsFile);
+    QString errorString() const;
+
+    QStringList datasets() const;
+    static const QStringList& vocabulary();
+
+private:
+    QByteArray instance(int index, bool perturbed);
+    QString words(int count);
+
+    CorpusSpec m_Spec;
+    QRandomGenerator m_Random;
+    QString m_Error;
+};
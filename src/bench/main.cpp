@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+
+#include "benchmark.hpp"
+#include "compilationexport.hpp"
+#include "compiledquery.hpp"
+#include "corpusgenerator.hpp"
+#include "helmdataconfig.hpp"
+#include "helmdirectoryindex.hpp"
+#include "helperfunctions.hpp"
+#include "promptsearch.hpp"
+#include "prompttreemodel.hpp"
+#include "queryparser.hpp"
+#include "trace.hpp"
+
+/*
+ * hpb-bench measures each stage of the search/import/export pipeline on
+ * synthetic corpora of increasing size:
+ *
+ *   parse       getQueries(), i.e. parsing and conversion to DNF, per query
+ *   compile     getQueryExpression() and CompiledQuery, per query
+ *   read-json   getTaskInstances() over instances.json, per dataset
+ *   cache-write the first cached read, which writes the binary cache, per dataset
+ *   read-cache  getTaskInstances() over the binary cache, per dataset
+ *   match       matches() over the prompts of a dataset, per dataset and query
+ *   search      searchDataset(), i.e. a cached read and matching, per dataset
+ *   search-all  a SearchJob over the whole corpus, on every core
+ *   insert      addPromptsToTree(), per dataset
+ *   export      an ExportJob, per dataset
+ *
+ * Peak RSS is the peak of the process at the end of the stage, so it only grows
+ * from one stage to the next.
+ */
+
+namespace {
+    struct Corpus {
+        CorpusSpec spec;
+        QString directory;
+
+        QString helmDataPath() const { return directory + "/runs"; }
+        QString helmTestsFile() const { return directory + "/helm_tests.json"; }
+        QString cachePath() const { return directory + "/cache"; }
+    };
+
+    void printError(const QString& message)
+    {
+        std::fprintf(stderr, "hpb-bench: %s\n", qPrintable(message));
+    }
+
+    bool runJob(BackgroundJob* job, const std::function<void()>& start)
+    {
+        QEventLoop loop;
+        bool cancelled = false;
+        const auto finished = QObject::connect(job, &BackgroundJob::finished, &loop, [&](bool jobCancelled) {
+            cancelled = jobCancelled;
+            loop.quit();
+        });
+        start();
+        if (job->isRunning()) {
+            loop.exec();
+        }
+        QObject::disconnect(finished);
+        return !cancelled;
+    }
+
+    QJsonObject toJson(const CorpusSpec& spec)
+    {
+        QJsonObject object;
+        object["datasets"] = spec.datasets;
+        object["instances_per_dataset"] = spec.instancesPerDataset;
+        object["prompt_words"] = spec.promptWords;
+        object["references_per_instance"] = spec.referencesPerInstance;
+        object["perturbed_fraction"] = spec.perturbedFraction;
+        object["models_per_dataset"] = spec.modelsPerDataset;
+        object["seed"] = static_cast<qint64>(spec.seed);
+        return object;
+    }
+
+    /**
+     * @brief Writes the corpus, unless the same one was written to its directory before.
+     */
+    bool prepareCorpus(const Corpus& corpus, const bool regenerate)
+    {
+        const QString specFile = corpus.directory + "/corpus.json";
+        QFile previous(specFile);
+        if (!regenerate && previous.open(QIODevice::ReadOnly) && QJsonDocument::fromJson(previous.readAll()).object() == toJson(corpus.spec)) {
+            return true;
+        }
+        previous.close();
+
+        std::fprintf(stderr, "Generating corpus %s in %s\n", qPrintable(corpus.spec.label()), qPrintable(corpus.directory));
+        QDir(corpus.directory).removeRecursively();
+        CorpusGenerator generator(corpus.spec);
+        if (!generator.write(corpus.helmDataPath(), corpus.helmTestsFile())) {
+            printError(generator.errorString());
+            return false;
+        }
+
+        QFile spec(specFile);
+        return spec.open(QIODevice::WriteOnly) && spec.write(QJsonDocument(toJson(corpus.spec)).toJson()) >= 0;
+    }
+
+    /**
+     * @brief Queries of increasing complexity over the corpus vocabulary.
+     */
+    QStringList benchmarkQueries()
+    {
+        const QStringList& words = CorpusGenerator::vocabulary();
+        return {
+            words.at(17),
+            words.at(101) + " & " + words.at(2048),
+            "(" + words.at(5) + " | " + words.at(733) + ") & !" + words.at(1999),
+            words.at(11) + " | " + words.at(1234) + " | " + words.at(3071) + " | " + words.at(4000),
+        };
+    }
+
+    /**
+     * @brief Runs every stage on a corpus.
+     *
+     * @return QList<StageSummary> The summary of each stage, in order.
+     */
+    QList<StageSummary> runBenchmarks(const Corpus& corpus, QThreadPool* pool, const int repetitions)
+    {
+        const QString label = corpus.spec.label();
+        const QString helmDataPath = corpus.helmDataPath();
+        const QStringList queries = benchmarkQueries();
+        QList<StageSummary> summaries;
+
+        HelmDirectoryIndex helmDirectoryIndex;
+        helmDirectoryIndex.update(helmDataPath);
+        const QStringList datasets = CorpusGenerator(corpus.spec).datasets();
+        const QStringList taskDirs = getHelmTaskDirs(datasets, helmDirectoryIndex);
+
+        StageMeasurement parse("parse", label);
+        for (int i = 0; i < repetitions; ++i) {
+            for (const QString& query : queries) {
+                parse.startOperation();
+                const auto terms = getQueries(query);
+                parse.endOperation(1, query.size());
+                Q_UNUSED(terms);
+            }
+        }
+        summaries.push_back(StageSummary::of(parse));
+
+        StageMeasurement compile("compile", label);
+        QList<CompiledQuery> compiled;
+        for (int i = 0; i < repetitions; ++i) {
+            compiled.clear();
+            for (const QString& query : queries) {
+                compile.startOperation();
+                compiled.push_back(CompiledQuery(getQueryExpression(query), false, false));
+                compile.endOperation(1, query.size());
+            }
+        }
+        summaries.push_back(StageSummary::of(compile));
+
+        // the prompts read are kept for the matching and insertion stages
+        QList<QStringList> inputs(datasets.size());
+        QList<QList<PromptTreeModel::NewPrompt>> prompts(datasets.size());
+        StageMeasurement readJson("read-json", label);
+        for (qsizetype i = 0; i < datasets.size(); ++i) {
+            readJson.startOperation();
+            const std::unique_ptr<InstanceReader> instances = getTaskInstances(taskDirs.at(i), helmDataPath, QString());
+            TaskInstance instance;
+            while (instances && instances->next(instance)) {
+                prompts[i].push_back({ instance.id, instance.index });
+                inputs[i].push_back(std::move(instance.input));
+            }
+            readJson.endOperation(inputs.at(i).size(), instances ? instances->size() : 0);
+        }
+        summaries.push_back(StageSummary::of(readJson));
+
+        // the bytes of each binary cache, which the search stages read
+        QList<qint64> cacheBytes(datasets.size());
+        QDir(corpus.cachePath()).removeRecursively();
+        for (const QString& stage : { QString("cache-write"), QString("read-cache") }) {
+            StageMeasurement read(stage, label);
+            for (qsizetype i = 0; i < datasets.size(); ++i) {
+                read.startOperation();
+                const std::unique_ptr<InstanceReader> instances = getTaskInstances(taskDirs.at(i), helmDataPath, corpus.cachePath());
+                TaskInstance instance;
+                qint64 count = 0;
+                while (instances && instances->next(instance)) {
+                    ++count;
+                }
+                cacheBytes[i] = instances ? instances->size() : 0;
+                read.endOperation(count, cacheBytes.at(i));
+            }
+            summaries.push_back(StageSummary::of(read));
+        }
+
+        StageMeasurement match("match", label);
+        for (const CompiledQuery& query : std::as_const(compiled)) {
+            for (const QStringList& datasetInputs : std::as_const(inputs)) {
+                qint64 bytes = 0;
+                qint64 matching = 0;
+                match.startOperation();
+                for (const QString& input : datasetInputs) {
+                    matching += matches(input, query) ? 1 : 0;
+                    bytes += input.size() * qsizetype(sizeof(QChar));
+                }
+                match.endOperation(datasetInputs.size(), bytes);
+                Q_UNUSED(matching);
+            }
+        }
+        summaries.push_back(StageSummary::of(match));
+
+        StageMeasurement search("search", label);
+        for (qsizetype i = 0; i < datasets.size(); ++i) {
+            search.startOperation();
+            searchDataset(datasets.at(i), taskDirs.at(i), helmDataPath, corpus.cachePath(), compiled.first(), false);
+            search.endOperation(inputs.at(i).size(), cacheBytes.at(i));
+        }
+        summaries.push_back(StageSummary::of(search));
+
+        StageMeasurement searchAll("search-all", label);
+        SearchJob searchJob(pool);
+        qint64 totalInstances = 0;
+        qint64 totalBytes = 0;
+        for (qsizetype i = 0; i < datasets.size(); ++i) {
+            totalInstances += inputs.at(i).size();
+            totalBytes += cacheBytes.at(i);
+        }
+        searchAll.startOperation();
+        runJob(&searchJob, [&]() {
+            searchJob.start(datasets, taskDirs, helmDataPath, corpus.cachePath(), compiled.first(), false);
+        });
+        searchAll.endOperation(totalInstances, totalBytes);
+        summaries.push_back(StageSummary::of(searchAll));
+
+        inputs.clear();
+
+        PromptTreeModel model;
+        StageMeasurement insert("insert", label);
+        for (qsizetype i = 0; i < datasets.size(); ++i) {
+            insert.startOperation();
+            addPromptsToTree({ datasets.at(i), helmDataPath, taskDirs.at(i) }, prompts.at(i), &model);
+            insert.endOperation(prompts.at(i).size(), 0);
+        }
+        summaries.push_back(StageSummary::of(insert));
+
+        const PromptStore& store = model.store();
+        model.setSelected(store.attachedPrompts(), true);
+        HelmDataConfig helmDataConfig;
+        helmDataConfig.update(corpus.helmTestsFile());
+        const QList<ExportDataset> exported = exportDatasets(store, helmDataConfig);
+
+        StageMeasurement exportStage("export", label);
+        ExportJob exportJob(pool);
+        const QString exportFile = corpus.directory + "/compilation.json";
+        for (const ExportDataset& dataset : exported) {
+            exportStage.startOperation();
+            runJob(&exportJob, [&]() {
+                exportJob.start(&store, { dataset }, exportFile, "benchmark");
+            });
+            exportStage.endOperation(store.prompts(dataset.group).size(), QFileInfo(exportFile).size());
+            if (!exportJob.errorString().isEmpty()) {
+                printError(exportJob.errorString());
+            }
+        }
+        summaries.push_back(StageSummary::of(exportStage));
+
+        return summaries;
+    }
+
+    bool parseCorpusSize(const QString& size, CorpusSpec& spec)
+    {
+        const QStringList parts = size.split('x');
+        bool datasetsOk = false;
+        bool instancesOk = false;
+        if (parts.size() == 2) {
+            spec.datasets = parts.at(0).toInt(&datasetsOk);
+            spec.instancesPerDataset = parts.at(1).toInt(&instancesOk);
+        }
+        return datasetsOk && instancesOk && spec.datasets > 0 && spec.instancesPerDataset > 0;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hpb-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the search, import and export pipeline on synthetic HELM corpora.");
+    parser.addHelpOption();
+
+    const CorpusSpec defaults;
+    const QCommandLineOption workDirOption("work-dir", "The directory the corpora are generated in, and kept for later runs.", "dir",
+                                           QDir::temp().filePath("hpb-bench"));
+    const QCommandLineOption corpusOption({ "c", "corpus" }, "A corpus size, as <datasets>x<instances>; may be repeated.", "size");
+    const QCommandLineOption promptWordsOption("prompt-words", "The mean number of words of a prompt.", "count", QString::number(defaults.promptWords));
+    const QCommandLineOption referencesOption("references", "The number of references of an instance.", "count", QString::number(defaults.referencesPerInstance));
+    const QCommandLineOption perturbedOption("perturbed", "The share of instances followed by a perturbed copy.", "fraction", QString::number(defaults.perturbedFraction));
+    const QCommandLineOption modelsOption("models", "The number of models each dataset was evaluated on.", "count", QString::number(defaults.modelsPerDataset));
+    const QCommandLineOption seedOption("seed", "The seed of the generator.", "seed", QString::number(defaults.seed));
+    const QCommandLineOption generateOnlyOption("generate-only", "Generate the corpora and exit.");
+    const QCommandLineOption regenerateOption("regenerate", "Generate the corpora even if they exist.");
+    const QCommandLineOption repetitionsOption("repetitions", "How many times the queries are parsed and compiled.", "count", "1000");
+    const QCommandLineOption threadsOption({ "j", "threads" }, "The number of worker threads of the search-all and export stages.", "count");
+    const QCommandLineOption saveBaselineOption("save-baseline", "Save the results as a baseline.", "file");
+    const QCommandLineOption baselineOption("baseline", "Compare the results with a baseline; exits with 1 on a regression.", "file");
+    const QCommandLineOption toleranceOption("tolerance", "The change from the baseline tolerated, in percent.", "percent", "10");
+    parser.addOptions({ workDirOption, corpusOption, promptWordsOption, referencesOption, perturbedOption, modelsOption,
+                        seedOption, generateOnlyOption, regenerateOption, repetitionsOption, threadsOption,
+                        saveBaselineOption, baselineOption, toleranceOption });
+    parser.process(app);
+
+    // tracing a benchmark shows where a stage spends its time, at the cost of its numbers
+    const TraceSession trace(qEnvironmentVariable("HPB_TRACE"));
+
+    CorpusSpec spec;
+    spec.promptWords = parser.value(promptWordsOption).toInt();
+    spec.referencesPerInstance = parser.value(referencesOption).toInt();
+    spec.perturbedFraction = parser.value(perturbedOption).toDouble();
+    spec.modelsPerDataset = parser.value(modelsOption).toInt();
+    spec.seed = parser.value(seedOption).toUInt();
+
+    QStringList sizes = parser.values(corpusOption);
+    if (sizes.isEmpty()) {
+        sizes = { "10x500", "20x2500", "40x5000" };
+    }
+
+    QList<Corpus> corpora;
+    for (const QString& size : std::as_const(sizes)) {
+        if (!parseCorpusSize(size, spec)) {
+            printError("invalid corpus size " + size);
+            return 2;
+        }
+        corpora.push_back({ spec, QDir(parser.value(workDirOption)).filePath(spec.label()) });
+    }
+
+    for (const Corpus& corpus : std::as_const(corpora)) {
+        if (!prepareCorpus(corpus, parser.isSet(regenerateOption))) {
+            return 1;
+        }
+    }
+    if (parser.isSet(generateOnlyOption)) {
+        return 0;
+    }
+
+    QThreadPool pool;
+    const int threads = parser.value(threadsOption).toInt();
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+
+    QList<StageSummary> summaries;
+    for (const Corpus& corpus : std::as_const(corpora)) {
+        std::fprintf(stderr, "Benchmarking corpus %s\n", qPrintable(corpus.spec.label()));
+        summaries += runBenchmarks(corpus, &pool, std::max(1, parser.value(repetitionsOption).toInt()));
+    }
+    printSummaries(summaries);
+
+    if (parser.isSet(saveBaselineOption) && !saveBaseline(parser.value(saveBaselineOption), summaries)) {
+        printError("failed to write " + parser.value(saveBaselineOption));
+        return 1;
+    }
+
+    if (parser.isSet(baselineOption)) {
+        QList<StageSummary> baseline;
+        if (!loadBaseline(parser.value(baselineOption), baseline)) {
+            printError("failed to read the baseline " + parser.value(baselineOption));
+            return 1;
+        }
+        std::printf("\n");
+        return compareWithBaseline(summaries, baseline, parser.value(toleranceOption).toDouble()) > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+
+#include "compilationexport.hpp"
+#include "compiledquery.hpp"
+#include "datasetmanifest.hpp"
+#include "helmdataconfig.hpp"
+#include "helmdirectoryindex.hpp"
+#include "helperfunctions.hpp"
+#include "promptsearch.hpp"
+#include "prompttextcache.hpp"
+#include "prompttreemodel.hpp"
+#include "queryparser.hpp"
+#include "trace.hpp"
+
+/*
+ * hpb-cli builds a compilation without a display, with the same steps as the GUI:
+ *
+ *   1. search the given datasets (or all of them) for prompts matching a query
+ *   2. remove the prompts matching a filter query
+ *   3. assign a CID to the remaining prompts
+ *   4. select them and export them to a compilation file
+ *
+ * Each step runs on a thread pool of all cores unless told otherwise. Progress
+ * goes to stderr; without an output file, the number of prompts per dataset is
+ * printed to stdout instead.
+ */
+
+namespace {
+    void printError(const QString& message)
+    {
+        std::fprintf(stderr, "hpb-cli: %s\n", qPrintable(message));
+    }
+
+    /**
+     * @brief Starts a job and waits for it in a local event loop, reporting its progress to stderr.
+     *
+     * @return bool False if the job was cancelled.
+     */
+    bool runJob(BackgroundJob* job, const QString& description, const std::function<void()>& start)
+    {
+        QEventLoop loop;
+        bool cancelled = false;
+        const auto progress = QObject::connect(job, &BackgroundJob::progressChanged, &loop, [&](qint64 done, qint64 total) {
+            std::fprintf(stderr, "\r%s: %3d%%", qPrintable(description), total > 0 ? static_cast<int>(done * 100 / total) : 100);
+        });
+        const auto finished = QObject::connect(job, &BackgroundJob::finished, &loop, [&](bool jobCancelled) {
+            cancelled = jobCancelled;
+            loop.quit();
+        });
+
+        start();
+        if (job->isRunning()) {
+            loop.exec();
+        }
+        std::fprintf(stderr, "\n");
+
+        QObject::disconnect(progress);
+        QObject::disconnect(finished);
+        return !cancelled;
+    }
+
+    /**
+     * @brief Compiles a query typed with the GUI's syntax, e.g. `(cat AND dog) OR NOT bird`.
+     *
+     * @return bool False if the query is not well-formed, or contains an invalid regular expression.
+     */
+    bool compileQuery(QString text, const bool caseSensitive, const bool regex, CompiledQuery& query)
+    {
+        text = text.trimmed().replace("NOT", "!").replace("AND", "&").replace("OR", "|");
+        if (!checkQuery(text)) {
+            printError("query is not well-formed: " + text);
+            return false;
+        }
+        query = CompiledQuery(getQueryExpression(text), caseSensitive, regex);
+        if (!query.isValid()) {
+            printError("query contains an invalid regular expression: " + query.errorString());
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hpb-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Builds a HELM prompt compilation without the GUI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("datasets", "The datasets to search, e.g. `mmlu:subject=anatomy,method=multiple_choice_joint`.", "[datasets...]");
+
+    const QCommandLineOption helmDataOption("helm-data", "The HELM data directory (benchmark_output/runs/<version>).", "dir");
+    const QCommandLineOption cacheOption("cache", "The directory of instance caches and indexes, shared with the GUI.", "dir",
+                                         QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/HELMPromptBrowser");
+    const QCommandLineOption noCacheOption("no-cache", "Read every instances.json file and write no cache.");
+    const QCommandLineOption allDatasetsOption("all-datasets", "Search every dataset of the HELM data directory.");
+    const QCommandLineOption listDatasetsOption("list-datasets", "Print the datasets of the HELM data directory and exit.");
+    const QCommandLineOption queryOption({ "q", "query" }, "Keep the prompts matching the query; all prompts if omitted.", "query");
+    const QCommandLineOption caseSensitiveOption("case-sensitive", "Match the search query case-sensitively.");
+    const QCommandLineOption regexOption("regex", "Match the terms of the search query as regular expressions.");
+    const QCommandLineOption indexOption("index", "Use the full-text index, writing it along with the cache when missing.");
+    const QCommandLineOption filterOption({ "f", "filter" }, "Remove the prompts matching the query.", "query");
+    const QCommandLineOption filterCaseSensitiveOption("filter-case-sensitive", "Match the filter query case-sensitively.");
+    const QCommandLineOption filterRegexOption("filter-regex", "Match the terms of the filter query as regular expressions.");
+    const QCommandLineOption cidOption("cid", "Assign the CID to the remaining prompts.", "cid");
+    const QCommandLineOption outputOption({ "o", "output" }, "Export the remaining prompts to the compilation file.", "file");
+    const QCommandLineOption nameOption("name", "The name of the compilation; the output file name if omitted.", "name");
+    const QCommandLineOption helmTestsOption("helm-tests", "PNYX's helm_tests.json, with the metric and split of each dataset.", "file");
+    const QCommandLineOption threadsOption({ "j", "threads" }, "The number of worker threads; all cores if omitted.", "count");
+    const QCommandLineOption traceOption("trace", "Write a Chrome trace of the run to the file; defaults to $HPB_TRACE.", "file",
+                                         qEnvironmentVariable("HPB_TRACE"));
+    parser.addOptions({ helmDataOption, cacheOption, noCacheOption, allDatasetsOption, listDatasetsOption,
+                        queryOption, caseSensitiveOption, regexOption, indexOption,
+                        filterOption, filterCaseSensitiveOption, filterRegexOption,
+                        cidOption, outputOption, nameOption, helmTestsOption, threadsOption, traceOption });
+    parser.process(app);
+
+    const TraceSession trace(parser.value(traceOption));
+
+    /***********************
+     * CHECK THE ARGUMENTS *
+     ***********************/
+
+    const QString helmDataPath = parser.value(helmDataOption);
+    if (helmDataPath.isEmpty() || !QFileInfo(helmDataPath).isDir()) {
+        printError("--helm-data must name a HELM data directory");
+        return 2;
+    }
+    const QString cachePath = parser.isSet(noCacheOption) ? QString() : parser.value(cacheOption);
+
+    const QString outputFile = parser.value(outputOption);
+    if (!outputFile.isEmpty() && !parser.isSet(helmTestsOption)) {
+        printError("--output needs --helm-tests");
+        return 2;
+    }
+
+    CompiledQuery query(getQueryExpression(QString()), false, false);
+    if (parser.isSet(queryOption)
+        && !compileQuery(parser.value(queryOption), parser.isSet(caseSensitiveOption), parser.isSet(regexOption), query)) {
+        return 2;
+    }
+    CompiledQuery filter(getQueryExpression(QString()), false, false);
+    if (parser.isSet(filterOption)
+        && !compileQuery(parser.value(filterOption), parser.isSet(filterCaseSensitiveOption), parser.isSet(filterRegexOption), filter)) {
+        return 2;
+    }
+
+    QThreadPool pool;
+    bool threadsOk = true;
+    const int threads = parser.isSet(threadsOption) ? parser.value(threadsOption).toInt(&threadsOk) : 0;
+    if (!threadsOk || threads < 0) {
+        printError("--threads must be a positive number");
+        return 2;
+    }
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+
+    /********************
+     * RESOLVE DATASETS *
+     ********************/
+
+    QStringList datasets = parser.positionalArguments();
+    if (parser.isSet(allDatasetsOption) || parser.isSet(listDatasetsOption)) {
+        DatasetManifest manifest;
+        manifest.setManifestFile(cachePath.isEmpty() ? QString() : QDir(cachePath).filePath("datasets.hpbm"));
+        manifest.update(helmDataPath);
+        for (const DatasetManifest::Dataset& dataset : manifest.datasets()) {
+            if (parser.isSet(listDatasetsOption)) {
+                std::printf("%s\n", qPrintable(dataset.name));
+            }
+            else if (!datasets.contains(dataset.name)) {
+                datasets.push_back(dataset.name);
+            }
+        }
+        if (parser.isSet(listDatasetsOption)) {
+            return 0;
+        }
+    }
+    if (datasets.isEmpty()) {
+        printError("no dataset given; name some or pass --all-datasets");
+        return 2;
+    }
+
+    HelmDirectoryIndex helmDirectoryIndex;
+    helmDirectoryIndex.update(helmDataPath);
+    const QStringList allTaskDirs = getHelmTaskDirs(datasets, helmDirectoryIndex);
+    QStringList found;
+    QStringList taskDirs;
+    for (const qsizetype i : _range(qsizetype(0), datasets.size())) {
+        if (allTaskDirs.at(i).isEmpty()) {
+            printError("no HELM run directory found for " + datasets.at(i));
+            continue;
+        }
+        found.push_back(datasets.at(i));
+        taskDirs.push_back(allTaskDirs.at(i));
+    }
+
+    /**********
+     * SEARCH *
+     **********/
+
+    PromptTreeModel model;
+    const PromptStore& store = model.store();
+    int status = 0;
+
+    SearchJob searchJob(&pool);
+    QObject::connect(&searchJob, &SearchJob::datasetsReady, [&](const QList<DatasetMatches>& matches) {
+        for (const DatasetMatches& datasetMatches : matches) {
+            if (!datasetMatches.error.isEmpty()) {
+                printError(datasetMatches.error);
+                status = 1;
+            }
+            addPromptsToTree(datasetMatches.task, datasetMatches.prompts, &model);
+        }
+    });
+    if (!found.isEmpty()) {
+        runJob(&searchJob, "Searching", [&]() {
+            searchJob.start(found, taskDirs, helmDataPath, cachePath, query, parser.isSet(indexOption));
+        });
+    }
+
+    /**********
+     * FILTER *
+     **********/
+
+    if (parser.isSet(filterOption) && !store.attachedPrompts().isEmpty()) {
+        FilterJob filterJob(&pool);
+        const QList<TaskPrompts> prompts = groupPromptsByTask(store, store.attachedPrompts());
+        runJob(&filterJob, "Filtering", [&]() {
+            filterJob.start(prompts, cachePath, filter);
+        });
+        for (const QString& error : filterJob.errors()) {
+            printError(error);
+        }
+
+        QList<PromptStore::Node> nodes;
+        nodes.reserve(filterJob.matchingPrompts().size());
+        for (const PromptStore::PromptId prompt : filterJob.matchingPrompts()) {
+            nodes.push_back({ PromptStore::Node::Prompt, prompt });
+        }
+        if (!nodes.isEmpty()) {
+            model.removeNodes(nodes);
+        }
+    }
+
+    /**************
+     * ASSIGN CID *
+     **************/
+
+    const QList<PromptStore::PromptId> prompts = store.attachedPrompts();
+    if (parser.isSet(cidOption)) {
+        model.setCid(prompts, parser.value(cidOption));
+    }
+
+    /**********
+     * EXPORT *
+     **********/
+
+    if (outputFile.isEmpty()) {
+        for (PromptStore::GroupId group = 0; group < store.groupCount(); ++group) {
+            const qsizetype count = std::ranges::count_if(store.prompts(group), [&](const PromptStore::PromptId prompt) {
+                return store.isAttached(prompt);
+            });
+            if (count > 0) {
+                const QString& datasetBase = store.baseName(store.groupBase(group));
+                const QString& datasetSpec = store.groupSpec(group);
+                std::printf("%s\t%lld\n", qPrintable(datasetSpec.isEmpty() ? datasetBase : datasetBase + ":" + datasetSpec), static_cast<long long>(count));
+            }
+        }
+        return status;
+    }
+
+    HelmDataConfig helmDataConfig;
+    if (!helmDataConfig.update(parser.value(helmTestsOption))) {
+        printError("no dataset configuration in " + parser.value(helmTestsOption));
+        return 1;
+    }
+
+    // the GUI exports the prompts the user selected; here, every prompt left
+    model.setSelected(prompts, true);
+    const QList<ExportDataset> exported = exportDatasets(store, helmDataConfig);
+    for (const QString& conflict : incompatibleCids(store, exported)) {
+        printError("CID used with different metrics: " + conflict);
+    }
+
+    const QString absoluteOutput = QFileInfo(outputFile).absoluteFilePath();
+    QDir().mkpath(QFileInfo(absoluteOutput).absolutePath());
+    const QString compilationName = parser.isSet(nameOption) ? parser.value(nameOption) : QFileInfo(outputFile).completeBaseName();
+
+    ExportJob exportJob(&pool);
+    runJob(&exportJob, "Exporting", [&]() {
+        exportJob.start(&store, exported, absoluteOutput, compilationName);
+    });
+    if (!exportJob.errorString().isEmpty()) {
+        printError(exportJob.errorString());
+        return 1;
+    }
+
+    std::fprintf(stderr, "%lld prompts in %lld datasets written to %s\n",
+                 static_cast<long long>(prompts.size()), static_cast<long long>(exported.size()), qPrintable(absoluteOutput));
+    return status;
+}
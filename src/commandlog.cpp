@@ -0,0 +1,384 @@
+#include "commandlog.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include <QHash>
+
+/************
+ * IdRanges *
+ ************/
+
+/**
+ * @brief Builds the set of the given ids; duplicates are ignored.
+ *
+ * @param ids The ids, in any order.
+ * @return IdRanges The set.
+ */
+IdRanges IdRanges::fromIds(QList<qint32> ids)
+{
+    std::ranges::sort(ids);
+
+    IdRanges ranges;
+    for (const qint32 id : ids) {
+        if (!ranges.m_Ranges.isEmpty()) {
+            Range& last = ranges.m_Ranges.last();
+            if (id < last.first + last.count) {
+                continue;
+            }
+            if (id == last.first + last.count) {
+                ++last.count;
+                continue;
+            }
+        }
+        ranges.m_Ranges.push_back({ id, 1 });
+    }
+    ranges.m_Ranges.squeeze();
+    return ranges;
+}
+
+/**
+ * @brief Lists the ids of the set in ascending order.
+ */
+QList<qint32> IdRanges::ids() const
+{
+    QList<qint32> ids;
+    ids.reserve(count());
+    for (const Range& range : m_Ranges) {
+        for (qint32 id = range.first; id < range.first + range.count; ++id) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+qsizetype IdRanges::count() const
+{
+    qsizetype count = 0;
+    for (const Range& range : m_Ranges) {
+        count += range.count;
+    }
+    return count;
+}
+
+qsizetype IdRanges::memoryUsage() const
+{
+    return m_Ranges.capacity() * qsizetype(sizeof(Range));
+}
+
+/**************
+ * CommandLog *
+ **************/
+
+CommandLog::CommandLog(PromptTreeModel* model, QObject* parent)
+    : QObject(parent)
+    , m_Model(model)
+{}
+
+/**
+ * @brief Sets the number of bytes the recorded commands may take, dropping the oldest ones if needed.
+ *
+ * @param bytes The limit.
+ */
+void CommandLog::setMemoryLimit(const qsizetype bytes)
+{
+    m_MemoryLimit = bytes;
+    enforceMemoryLimit();
+    emit changed();
+}
+
+qsizetype CommandLog::memoryUsage() const
+{
+    return m_MemoryUsage;
+}
+
+/**
+ * @brief Removes bases, groups and prompts from the tree.
+ *
+ * @param nodes The nodes to remove; those already removed are ignored.
+ */
+void CommandLog::remove(const QList<Node>& nodes)
+{
+    const PromptStore& store = m_Model->store();
+
+    QList<Node> removed;
+    QList<qint32> ids[3];
+    for (const Node node : nodes) {
+        if (node.id < 0 || store.isRemoved(node)) {
+            continue;
+        }
+        removed.push_back(node);
+        ids[node.kind].push_back(node.id);
+    }
+    if (removed.isEmpty()) {
+        return;
+    }
+
+    m_Model->removeNodes(removed);
+
+    QList<Change> changes;
+    for (const Node::Kind kind : { Node::Base, Node::Group, Node::Prompt }) {
+        if (!ids[kind].isEmpty()) {
+            changes.push_back({ Change::Remove, kind, 0, 0, IdRanges::fromIds(ids[kind]) });
+        }
+    }
+    record(std::move(changes));
+}
+
+/**
+ * @brief Marks prompts as selected for, or excluded from, the compilation.
+ *
+ * @param prompts The prompts; only those whose status changes are recorded.
+ * @param selected The new selection status.
+ */
+void CommandLog::setSelected(const QList<PromptStore::PromptId>& prompts, const bool selected)
+{
+    const PromptStore& store = m_Model->store();
+
+    QList<PromptStore::PromptId> changed;
+    for (const PromptStore::PromptId prompt : prompts) {
+        if (store.isSelected(prompt) != selected) {
+            changed.push_back(prompt);
+        }
+    }
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    m_Model->setSelected(changed, selected);
+    record({ { Change::SetSelected, Node::Prompt, !selected, selected, IdRanges::fromIds(changed) } });
+}
+
+/**
+ * @brief Assigns a CID to prompts.
+ *
+ * @param prompts The prompts; only those whose CID changes are recorded.
+ * @param cid The CID; an empty string clears it.
+ */
+void CommandLog::setCid(const QList<PromptStore::PromptId>& prompts, const QString& cid)
+{
+    const PromptStore& store = m_Model->store();
+    const qint32 current = store.findCid(cid);
+
+    // the previous CIDs are recorded as one change per distinct value
+    QHash<qint32, QList<PromptStore::PromptId>> promptsByOldCid;
+    QList<PromptStore::PromptId> changed;
+    for (const PromptStore::PromptId prompt : prompts) {
+        const qint32 oldCid = store.cidIndex(prompt);
+        if (oldCid != current) {
+            promptsByOldCid[oldCid].push_back(prompt);
+            changed.push_back(prompt);
+        }
+    }
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    m_Model->setCid(changed, cid);
+    const qint32 newCid = store.findCid(cid);
+
+    QList<Change> changes;
+    for (const auto [oldCid, ids] : promptsByOldCid.asKeyValueRange()) {
+        changes.push_back({ Change::SetCid, Node::Prompt, oldCid, newCid, IdRanges::fromIds(ids) });
+    }
+    record(std::move(changes));
+}
+
+/**
+ * @brief Starts grouping the following edits into a single command, e.g. for an import.
+ *
+ * Calls may be nested; the command is recorded by the outermost endCommand().
+ */
+void CommandLog::beginCommand()
+{
+    ++m_Nesting;
+}
+
+/**
+ * @brief Records the nodes added to the store since it had the given numbers of nodes.
+ *
+ * The store numbers nodes in insertion order, so the added nodes are the ids
+ * from the former counts up to the current ones. Undoing removes them.
+ *
+ * @param baseCount The number of bases before the addition.
+ * @param groupCount The number of groups before the addition.
+ * @param promptCount The number of prompts before the addition.
+ */
+void CommandLog::recordAddedSince(const qsizetype baseCount, const qsizetype groupCount, const qsizetype promptCount)
+{
+    const PromptStore& store = m_Model->store();
+
+    QList<Change> changes;
+    const std::tuple<Node::Kind, qsizetype, qsizetype> added[] = {
+        { Node::Base, baseCount, store.baseCount() },
+        { Node::Group, groupCount, store.groupCount() },
+        { Node::Prompt, promptCount, store.promptCount() },
+    };
+    for (const auto& [kind, first, last] : added) {
+        QList<qint32> ids;
+        ids.reserve(last - first);
+        for (qsizetype id = first; id < last; ++id) {
+            ids.push_back(static_cast<qint32>(id));
+        }
+        if (!ids.isEmpty()) {
+            changes.push_back({ Change::Add, kind, 0, 0, IdRanges::fromIds(std::move(ids)) });
+        }
+    }
+    record(std::move(changes));
+}
+
+void CommandLog::endCommand()
+{
+    Q_ASSERT(m_Nesting > 0);
+    if (--m_Nesting > 0) {
+        return;
+    }
+    QList<Change> changes = std::move(m_Pending);
+    m_Pending.clear();
+    record(std::move(changes));
+}
+
+bool CommandLog::canUndo() const
+{
+    return !m_Undo.isEmpty();
+}
+
+bool CommandLog::canRedo() const
+{
+    return !m_Redo.isEmpty();
+}
+
+void CommandLog::undo()
+{
+    if (m_Undo.isEmpty()) {
+        return;
+    }
+    Command command = m_Undo.takeLast();
+    apply(command, true);
+    m_Redo.push_back(std::move(command));
+    emit changed();
+}
+
+void CommandLog::redo()
+{
+    if (m_Redo.isEmpty()) {
+        return;
+    }
+    Command command = m_Redo.takeLast();
+    apply(command, false);
+    m_Undo.push_back(std::move(command));
+    emit changed();
+}
+
+void CommandLog::clear()
+{
+    m_Undo.clear();
+    m_Redo.clear();
+    m_Pending.clear();
+    m_MemoryUsage = 0;
+    emit changed();
+}
+
+/***********
+ * Helpers *
+ ***********/
+
+qsizetype CommandLog::Command::memoryUsage() const
+{
+    qsizetype bytes = sizeof(Command);
+    for (const Change& change : changes) {
+        bytes += sizeof(Change) + change.ids.memoryUsage();
+    }
+    return bytes;
+}
+
+void CommandLog::record(QList<Change> changes)
+{
+    if (m_Nesting > 0) {
+        m_Pending += std::move(changes);
+        return;
+    }
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    for (const Command& command : std::as_const(m_Redo)) {
+        m_MemoryUsage -= command.memoryUsage();
+    }
+    m_Redo.clear();
+
+    Command command { std::move(changes) };
+    m_MemoryUsage += command.memoryUsage();
+    m_Undo.push_back(std::move(command));
+
+    enforceMemoryLimit();
+    emit changed();
+}
+
+/**
+ * @brief Applies the changes of a command to the model, or reverts them in reverse order.
+ *
+ * Consecutive changes that add or remove nodes are merged into a single batch.
+ */
+void CommandLog::apply(const Command& command, const bool undo)
+{
+    const PromptStore& store = m_Model->store();
+
+    QList<Node> batch;
+    bool batchRemoves = false;
+    const auto flush = [&]() {
+        if (batch.isEmpty()) {
+            return;
+        }
+        if (batchRemoves) {
+            m_Model->removeNodes(batch);
+        }
+        else {
+            m_Model->restoreNodes(batch);
+        }
+        batch.clear();
+    };
+
+    const qsizetype count = command.changes.size();
+    for (qsizetype i = 0; i < count; ++i) {
+        const Change& change = command.changes.at(undo ? count - 1 - i : i);
+        const qint32 value = undo ? change.oldValue : change.newValue;
+
+        switch (change.kind) {
+        case Change::Remove:
+        case Change::Add: {
+            const bool removes = (change.kind == Change::Remove) != undo;
+            if (removes != batchRemoves) {
+                flush();
+                batchRemoves = removes;
+            }
+            for (const qint32 id : change.ids.ids()) {
+                batch.push_back({ change.nodeKind, id });
+            }
+            break;
+        }
+        case Change::SetCid:
+            flush();
+            m_Model->setCid(change.ids.ids(), store.cidName(value));
+            break;
+        case Change::SetSelected:
+            flush();
+            m_Model->setSelected(change.ids.ids(), value != 0);
+            break;
+        }
+    }
+    flush();
+}
+
+/**
+ * @brief Drops the oldest undoable commands, then the furthest redoable ones, until the log fits its limit.
+ */
+void CommandLog::enforceMemoryLimit()
+{
+    while (m_MemoryUsage > m_MemoryLimit && !m_Undo.isEmpty()) {
+        m_MemoryUsage -= m_Undo.takeFirst().memoryUsage();
+    }
+    while (m_MemoryUsage > m_MemoryLimit && !m_Redo.isEmpty()) {
+        m_MemoryUsage -= m_Redo.takeFirst().memoryUsage();
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "promptstore.hpp"
+#include "prompttreemodel.hpp"
+
+/**
+ * @brief A set of node ids, stored as sorted runs of consecutive ids.
+ *
+ * Prompts touched by a bulk operation usually come in long runs (a whole
+ * dataset, a filter over a search result), so a run costs eight bytes however
+ * many prompts it covers.
+ */
+class IdRanges
+{
+public:
+    static IdRanges fromIds(QList<qint32> ids);
+
+    QList<qint32> ids() const;
+    qsizetype count() const;
+    qsizetype memoryUsage() const;
+
+private:
+    struct Range
+    {
+        qint32 first = 0;
+        qint32 count = 0;
+    };
+
+    QList<Range> m_Ranges;
+};
+
+/**
+ * @brief Performs the edits of the prompt tree and records them so that they can be undone and redone.
+ *
+ * Every command is a list of compact changes: which nodes were removed or added,
+ * or which prompts had their CID or selection changed and from which value, with
+ * interned CIDs. Undoing or redoing a command applies each of its changes to the
+ * model as one batch.
+ *
+ * The log holds at most a configurable number of bytes; the oldest commands are
+ * dropped first, and a command that does not fit on its own is not recorded.
+ * Node ids and interned CIDs are only valid until the store is cleared, so the
+ * log must be cleared with it.
+ */
+class CommandLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Node = PromptStore::Node;
+
+    explicit CommandLog(PromptTreeModel* model, QObject* parent = nullptr);
+
+    void setMemoryLimit(qsizetype bytes);
+    qsizetype memoryUsage() const;
+
+    void remove(const QList<Node>& nodes);
+    void setSelected(const QList<PromptStore::PromptId>& prompts, bool selected);
+    void setCid(const QList<PromptStore::PromptId>& prompts, const QString& cid);
+
+    void beginCommand();
+    void recordAddedSince(qsizetype baseCount, qsizetype groupCount, qsizetype promptCount);
+    void endCommand();
+
+    bool canUndo() const;
+    bool canRedo() const;
+    void undo();
+    void redo();
+    void clear();
+
+signals:
+    void changed();
+
+private:
+    struct Change
+    {
+        enum Kind : quint8 {
+            Remove,
+            Add,
+            SetCid,
+            SetSelected,
+        };
+
+        Kind kind = Remove;
+        Node::Kind nodeKind = Node::Prompt;
+        qint32 oldValue = 0;    // interned CID or selection status
+        qint32 newValue = 0;
+        IdRanges ids;
+    };
+
+    struct Command
+    {
+        QList<Change> changes;
+        qsizetype memoryUsage() const;
+    };
+
+    void record(QList<Change> changes);
+    void apply(const Command& command, bool undo);
+    void enforceMemoryLimit();
+
+    PromptTreeModel* m_Model;
+    QList<Command> m_Undo;
+    QList<Command> m_Redo;
+    qsizetype m_MemoryLimit = 64 * 1024 * 1024;
+    qsizetype m_MemoryUsage = 0;
+
+    // changes recorded between beginCommand() and endCommand()
+    int m_Nesting = 0;
+    QList<Change> m_Pending;
+};
@@ -0,0 +1,346 @@
+#include "compilationexport.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <QHash>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+
+#include "helperfunctions.hpp"
+#include "trace.hpp"
+
+namespace {
+    // the writer hands its buffer to the file whenever it grows past this size
+    constexpr qsizetype flushThreshold = 64 * 1024;
+} // namespace
+
+/*********************
+ * CompilationWriter *
+ *********************/
+
+CompilationWriter::CompilationWriter(const QString& fileName)
+    : m_File(fileName)
+{}
+
+/**
+ * @brief Opens the temporary file and writes the compilation header.
+ *
+ * @param compilationName The name of the compilation.
+ * @return bool False if the file could not be opened.
+ */
+bool CompilationWriter::open(const QString& compilationName)
+{
+    if (!m_File.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    m_Buffer.reserve(flushThreshold * 2);
+    m_Buffer += "{\n    \"compilation_name\": ";
+    writeString(compilationName);
+    m_Buffer += ",\n    \"datasets\": [\n";
+    return true;
+}
+
+/**
+ * @brief Starts a (sub)dataset; its samples follow, then endDataset().
+ */
+void CompilationWriter::beginDataset(const QString& base, const QString& spec, const QString& metric, const QString& split)
+{
+    if (!m_FirstDataset) {
+        m_Buffer += ",\n";
+    }
+    m_FirstDataset = false;
+    m_FirstSample = true;
+    // "split" sorts after "samples", so it is written when the dataset ends
+    m_Split = split;
+
+    m_Buffer += "        {\n            ";
+    writeString(base);
+    m_Buffer += ": {\n                \"dataset_spec\": ";
+    writeString(spec);
+    m_Buffer += ",\n                \"metric\": ";
+    writeString(metric);
+    m_Buffer += ",\n                \"samples\": {\n";
+}
+
+/**
+ * @brief Writes a sample of the current dataset.
+ *
+ * Samples must come sorted by id, without duplicates, as QJsonObject keys would.
+ */
+void CompilationWriter::writeSample(const QStringView id, const QStringView cid)
+{
+    if (!m_FirstSample) {
+        m_Buffer += ",\n";
+    }
+    m_FirstSample = false;
+
+    m_Buffer += "                    ";
+    writeString(id);
+    m_Buffer += ": ";
+    writeString(cid);
+    flush();
+}
+
+void CompilationWriter::endDataset()
+{
+    if (!m_FirstSample) {
+        m_Buffer += '\n';
+    }
+    m_Buffer += "                },\n                \"split\": ";
+    writeString(m_Split);
+    m_Buffer += "\n            }\n        }";
+    flush();
+}
+
+/**
+ * @brief Closes the document and replaces the target file with it.
+ *
+ * @return bool False if writing failed; the target file is then left untouched.
+ */
+bool CompilationWriter::commit()
+{
+    const TraceSpan span("CompilationWriter::commit");
+
+    if (!m_FirstDataset) {
+        m_Buffer += '\n';
+    }
+    m_Buffer += "    ]\n}\n";
+    flush(true);
+    return m_File.commit();
+}
+
+QString CompilationWriter::errorString() const
+{
+    return m_File.errorString();
+}
+
+/**
+ * @brief Writes a JSON string literal, escaped as QJsonDocument does.
+ */
+void CompilationWriter::writeString(const QStringView string)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    m_Buffer += '"';
+    for (const char c : string.toUtf8()) {
+        switch (c) {
+        case '"':
+            m_Buffer += "\\\"";
+            break;
+        case '\\':
+            m_Buffer += "\\\\";
+            break;
+        case '\b':
+            m_Buffer += "\\b";
+            break;
+        case '\f':
+            m_Buffer += "\\f";
+            break;
+        case '\n':
+            m_Buffer += "\\n";
+            break;
+        case '\r':
+            m_Buffer += "\\r";
+            break;
+        case '\t':
+            m_Buffer += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                m_Buffer += "\\u00";
+                m_Buffer += hexDigits[(c >> 4) & 0xF];
+                m_Buffer += hexDigits[c & 0xF];
+            }
+            else {
+                m_Buffer += c;
+            }
+        }
+    }
+    m_Buffer += '"';
+}
+
+void CompilationWriter::flush(const bool force)
+{
+    if (m_Buffer.isEmpty() || (!force && m_Buffer.size() < flushThreshold)) {
+        return;
+    }
+    m_File.write(m_Buffer);
+    m_Buffer.resize(0);
+}
+
+/*******************
+ * Export datasets *
+ *******************/
+
+/**
+ * @brief Collects the (sub)datasets of the store that have selected prompts, in tree order.
+ *
+ * @param store The prompt store.
+ * @param helmDataConfig PNYX's `helm_tests.json`, for the metric and split of each dataset.
+ * @return QList<ExportDataset> The datasets to export.
+ */
+QList<ExportDataset> exportDatasets(const PromptStore& store, const HelmDataConfig& helmDataConfig)
+{
+    QList<ExportDataset> datasets;
+    const auto addDataset = [&](const PromptStore::GroupId group) -> void {
+        const QString& datasetBase = store.baseName(store.groupBase(group));
+        const QString& datasetSpec = store.groupSpec(group);
+        const HelmDatasetInfo info = helmDataConfig.find(datasetSpec.isEmpty() ? datasetBase : datasetBase + ":" + datasetSpec);
+        datasets.push_back({ group, datasetBase, datasetSpec, info.metric, info.split });
+    };
+
+    for (PromptStore::BaseId dataset = 0; dataset < store.baseCount(); ++dataset) {
+        if (store.isRemoved({ PromptStore::Node::Base, dataset })) {
+            continue;
+        }
+
+        const PromptStore::GroupId plainGroup = store.plainGroup(dataset);
+        if (plainGroup >= 0 && hasSelectedPrompts(store, plainGroup)) {
+            addDataset(plainGroup);
+        }
+
+        for (const PromptStore::GroupId subDataset : store.groups(dataset)) {
+            if (!store.isRemoved({ PromptStore::Node::Group, subDataset }) && hasSelectedPrompts(store, subDataset)) {
+                addDataset(subDataset);
+            }
+        }
+    }
+    return datasets;
+}
+
+/**
+ * @brief Lists the CIDs whose exported prompts come from datasets with different metrics.
+ *
+ * @param store The prompt store.
+ * @param datasets The exported (sub)datasets, with their metrics.
+ * @return QStringList One line per conflicting CID, naming it and its metrics.
+ */
+QStringList incompatibleCids(const PromptStore& store, const QList<ExportDataset>& datasets)
+{
+    QHash<qint32, QSet<QString>> metricsByCid;
+    for (const ExportDataset& dataset : datasets) {
+        for (const PromptStore::PromptId prompt : store.prompts(dataset.group)) {
+            const qint32 cid = store.cidIndex(prompt);
+            if (cid > 0 && store.isSelected(prompt) && !store.isRemoved({ PromptStore::Node::Prompt, prompt })) {
+                metricsByCid[cid].insert(dataset.metric);
+            }
+        }
+    }
+
+    QStringList conflicts;
+    for (const auto [cid, metrics] : metricsByCid.asKeyValueRange()) {
+        if (metrics.size() > 1) {
+            QStringList metricNames = metrics.values();
+            metricNames.sort();
+            conflicts.push_back(store.cidName(cid) + ": " + metricNames.join(", "));
+        }
+    }
+    conflicts.sort();
+    return conflicts;
+}
+
+/*************
+ * ExportJob *
+ *************/
+
+ExportJob::ExportJob(QThreadPool* pool, QObject* parent)
+    : BackgroundJob(pool, parent)
+{
+    connect(&m_Watcher, &QFutureWatcher<QString>::finished, this, &ExportJob::onFinished);
+}
+
+ExportJob::~ExportJob()
+{
+    // unlike the other jobs, the worker reads the caller's store, so it must not outlive it
+    cancel();
+    m_Watcher.waitForFinished();
+}
+
+/**
+ * @brief Starts writing a compilation.
+ *
+ * @param store The prompt store; it must stay unchanged until the job has finished.
+ * @param datasets The (sub)datasets to write, in order; their selected prompts are written as samples.
+ * @param fileName The compilation file.
+ * @param compilationName The name of the compilation.
+ */
+void ExportJob::start(const PromptStore* store,
+                      const QList<ExportDataset>& datasets,
+                      const QString& fileName,
+                      const QString& compilationName)
+{
+    Q_ASSERT(!isRunning());
+
+    const auto isSample = [store](const PromptStore::PromptId prompt) {
+        return !store->isRemoved({ PromptStore::Node::Prompt, prompt }) && store->isSelected(prompt);
+    };
+
+    qint64 total = 0;
+    for (const ExportDataset& dataset : datasets) {
+        total += std::ranges::count_if(store->prompts(dataset.group), isSample);
+    }
+
+    m_Error.clear();
+    begin(total);
+
+    std::shared_ptr<JobProgress> progress = m_Progress;
+    m_Watcher.setFuture(QtConcurrent::run(m_Pool, [=]() -> QString {
+        const TraceSpan span("ExportJob", fileName);
+        CompilationWriter writer(fileName);
+        if (!writer.open(compilationName)) {
+            return "Failed to open " + fileName + " for writing";
+        }
+
+        QList<PromptStore::PromptId> samples;
+        for (const ExportDataset& dataset : datasets) {
+            if (progress->cancelled.load(std::memory_order_relaxed)) {
+                return {};
+            }
+
+            samples.clear();
+            for (const PromptStore::PromptId prompt : store->prompts(dataset.group)) {
+                if (isSample(prompt)) {
+                    samples.push_back(prompt);
+                }
+            }
+            // QJsonObject sorted its keys and kept the last value of a duplicate one
+            std::stable_sort(samples.begin(), samples.end(), [store](const PromptStore::PromptId a, const PromptStore::PromptId b) {
+                return store->promptId(a) < store->promptId(b);
+            });
+
+            writer.beginDataset(dataset.base, dataset.spec, dataset.metric, dataset.split);
+            for (qsizetype i = 0; i < samples.size(); ++i) {
+                const QStringView id = store->promptId(samples.at(i));
+                if (i + 1 < samples.size() && store->promptId(samples.at(i + 1)) == id) {
+                    continue;
+                }
+                writer.writeSample(id, store->cid(samples.at(i)));
+            }
+            writer.endDataset();
+            progress->done.fetch_add(samples.size(), std::memory_order_relaxed);
+        }
+
+        if (progress->cancelled.load(std::memory_order_relaxed)) {
+            return {};
+        }
+        if (!writer.commit()) {
+            return "Failed to write " + fileName + ": " + writer.errorString();
+        }
+        return {};
+    }));
+}
+
+/**
+ * @brief The reason the last export failed, or an empty string if it succeeded or was cancelled.
+ */
+const QString& ExportJob::errorString() const
+{
+    return m_Error;
+}
+
+void ExportJob::onFinished()
+{
+    m_Error = m_Watcher.result();
+    end();
+}
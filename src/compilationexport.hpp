@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+#include "helmdataconfig.hpp"
+#include "promptsearch.hpp"
+#include "promptstore.hpp"
+
+/**
+ * @brief Writes a compilation file incrementally, in the format of QJsonDocument::toJson().
+ *
+ * Keys are written in the order QJsonObject sorts them, so the output is byte for
+ * byte the one of the former DOM-based export, without ever holding the whole
+ * document in memory:
+ *
+ *   { "compilation_name": ..., "datasets": [ { base: { "dataset_spec", "metric", "samples": { id: CID }, "split" } } ] }
+ *
+ * The file is written through a QSaveFile, so it only replaces the target once
+ * commit() succeeds; an abandoned writer leaves the previous file untouched.
+ */
+class CompilationWriter
+{
+public:
+    explicit CompilationWriter(const QString& fileName);
+
+    bool open(const QString& compilationName);
+    void beginDataset(const QString& base, const QString& spec, const QString& metric, const QString& split);
+    void writeSample(QStringView id, QStringView cid);
+    void endDataset();
+    bool commit();
+
+    QString errorString() const;
+
+private:
+    void writeString(QStringView string);
+    void flush(bool force = false);
+
+    QSaveFile m_File;
+    QByteArray m_Buffer;
+    QString m_Split;
+    bool m_FirstDataset = true;
+    bool m_FirstSample = true;
+};
+
+/**
+ * @brief A (sub)dataset of a compilation, with the HELM metadata written along with it.
+ */
+struct ExportDataset {
+    PromptStore::GroupId group = -1;
+    QString base;
+    QString spec;
+    QString metric;
+    QString split;
+};
+
+QList<ExportDataset> exportDatasets(const PromptStore& store, const HelmDataConfig& helmDataConfig);
+QStringList incompatibleCids(const PromptStore& store, const QList<ExportDataset>& datasets);
+
+/**
+ * @brief Writes the selected prompts of a prompt store to a compilation file on the thread pool.
+ *
+ * The worker reads the store directly instead of a snapshot, which would be as
+ * large as the DOM the streaming writer avoids; the store must not be modified
+ * until the job has finished. Progress is measured in samples written. A
+ * cancelled or failed job leaves the previous file untouched.
+ */
+class ExportJob : public BackgroundJob
+{
+    Q_OBJECT
+
+public:
+    explicit ExportJob(QThreadPool* pool, QObject* parent = nullptr);
+    ~ExportJob() override;
+
+    void start(const PromptStore* store,
+               const QList<ExportDataset>& datasets,
+               const QString& fileName,
+               const QString& compilationName);
+
+    const QString& errorString() const;
+
+private:
+    void onFinished();
+
+    QFutureWatcher<QString> m_Watcher;
+    QString m_Error;
+};
@@ -0,0 +1,194 @@
+#include "compiledquery.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include <QVarLengthArray>
+
+#include "logic.hpp"
+
+/**
+ * @brief Evaluates a node with short-circuiting.
+ *
+ * @param node The node index.
+ * @param test Returns whether the prompt contains a term, given its index.
+ * @return bool The value of the node.
+ */
+template <typename TermTest>
+bool CompiledQuery::evaluate(const int node, TermTest& test) const
+{
+    const Node& current = m_Nodes.at(node);
+    switch (current.op) {
+    case Operator::NIL:
+        return test(current.term);
+    case Operator::NOT:
+        return !test(current.term);
+    case Operator::AND:
+        return std::ranges::all_of(current.children, [&](const int child) { return evaluate(child, test); });
+    case Operator::OR:
+        return std::ranges::any_of(current.children, [&](const int child) { return evaluate(child, test); });
+    }
+    return false;
+}
+
+/**
+ * @brief Compiles the terms and structure of a query.
+ *
+ * @param query The parsed query, as returned by getQueryExpression().
+ * @param isCaseSensitive If true, terms are matched case-sensitively.
+ * @param isRegex If true, terms are regular expressions; otherwise, they are plain text.
+ */
+CompiledQuery::CompiledQuery(Expression query, const bool isCaseSensitive, const bool isRegex)
+    : m_IsCaseSensitive(isCaseSensitive), m_IsRegex(isRegex)
+{
+    auto expression = std::make_shared<const Expression>(toNNF(std::move(query)));
+
+    // literals are interned by the parser, so their ids double as term indices
+    m_TermTexts = expression->literals();
+    m_Terms.reserve(m_TermTexts.size());
+    for (const QString& term : std::as_const(m_TermTexts)) {
+        m_Terms.push_back(compileTerm(term));
+    }
+
+    if (expression->root() != Expression::NoNode) {
+        m_Root = compile(*expression, expression->root());
+    }
+    m_Expression = std::move(expression);
+
+    // a single literal is searched faster by QStringMatcher's skip table
+    if (!m_IsRegex && m_TermTexts.size() > 1) {
+        m_Automaton.emplace(m_TermTexts, m_IsCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    }
+}
+
+/**
+ * @brief Determines if a prompt matches the query.
+ *
+ * Each term is evaluated at most once per prompt, however often it occurs in the query.
+ *
+ * @param prompt The text to be matched.
+ * @return bool True if the query holds for the prompt.
+ */
+bool CompiledQuery::matches(const QStringView prompt) const
+{
+    if (m_Root < 0) {
+        return false;
+    }
+
+    if (m_Automaton) {
+        QVarLengthArray<quint64, 4> present(m_Automaton->wordCount());
+        m_Automaton->scan(prompt, present.data());
+        const auto promptContainsTerm = [&](const int term) {
+            return ((present[term / 64] >> (term % 64)) & 1) != 0;
+        };
+        return evaluate(m_Root, promptContainsTerm);
+    }
+
+    constexpr qint8 unknown = -1;
+    QVarLengthArray<qint8, 64> results(m_Terms.size(), unknown);
+    const auto promptMatchesTerm = [&](const int term) {
+        if (results[term] == unknown) {
+            results[term] = termMatches(term, prompt) ? 1 : 0;
+        }
+        return results[term] == 1;
+    };
+    return evaluate(m_Root, promptMatchesTerm);
+}
+
+const Expression& CompiledQuery::expression() const
+{
+    return *m_Expression;
+}
+
+bool CompiledQuery::isCaseSensitive() const
+{
+    return m_IsCaseSensitive;
+}
+
+bool CompiledQuery::isRegex() const
+{
+    return m_IsRegex;
+}
+
+/**
+ * @brief Checks that every regular expression in the query compiled.
+ *
+ * @return bool False if some term is not a valid regular expression.
+ */
+bool CompiledQuery::isValid() const
+{
+    return std::ranges::all_of(m_Terms, [](const Term& term) { return term.regex.isValid(); });
+}
+
+/**
+ * @brief Describes the first invalid regular expression in the query.
+ *
+ * @return QString The pattern and the reason it failed to compile, or an empty string.
+ */
+QString CompiledQuery::errorString() const
+{
+    for (const auto& term : m_Terms) {
+        if (!term.regex.isValid()) {
+            return term.regex.pattern() + ": " + term.regex.errorString();
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Turns an NNF subexpression into nodes, merging nested operators of the same kind.
+ *
+ * @param expr The query.
+ * @param node The root of the subexpression.
+ * @return int The index of its node.
+ */
+int CompiledQuery::compile(const Expression& expr, const Expression::NodeId node)
+{
+    const int index = static_cast<int>(m_Nodes.size());
+    m_Nodes.push_back({ expr.op(node) });
+
+    if (isAtomic(expr, node)) {
+        m_Nodes[index].term = expr.literalId(node);
+        return index;
+    }
+    if (isNegation(expr, node)) {
+        m_Nodes[index].term = expr.literalId(expr.scope(node));
+        return index;
+    }
+
+    QList<Expression::NodeId> operands = { expr.lhs(node), expr.rhs(node) };
+    QList<int> children;
+    while (!operands.isEmpty()) {
+        const Expression::NodeId operand = operands.takeFirst();
+        if (expr.op(operand) == expr.op(node)) {
+            operands.prepend(expr.rhs(operand));
+            operands.prepend(expr.lhs(operand));
+            continue;
+        }
+        children.push_back(compile(expr, operand));
+    }
+    m_Nodes[index].children = std::move(children);
+    return index;
+}
+
+CompiledQuery::Term CompiledQuery::compileTerm(const QString& term) const
+{
+    Term compiled;
+    if (m_IsRegex) {
+        compiled.regex = QRegularExpression(term, m_IsCaseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+        compiled.regex.optimize();
+    }
+    else {
+        compiled.matcher = QStringMatcher(term, m_IsCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    }
+    return compiled;
+}
+
+bool CompiledQuery::termMatches(const int term, const QStringView prompt) const
+{
+    const Term& compiled = m_Terms.at(term);
+    if (m_IsRegex) {
+        return compiled.regex.matchView(prompt).hasMatch();
+    }
+    return compiled.matcher.indexIn(prompt) >= 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QStringMatcher>
+#include <QStringView>
+
+#include "ahocorasick.hpp"
+#include "expression.hpp"
+
+/**
+ * @brief A search or filter query prepared for matching many prompts.
+ *
+ * Built once from the query's NNF expression: every interned literal is
+ * compiled a single time, as a QStringMatcher for plain text or as an
+ * optimized (JIT-compiled) QRegularExpression. Nested conjunctions and
+ * disjunctions are flattened into n-ary nodes that refer to terms by index
+ * and are evaluated with short-circuiting, so the cost of a query grows
+ * linearly with its size instead of with the size of its DNF.
+ *
+ * Term results are shared between all the places a term occurs. Plain-text
+ * queries with several terms get all their term results from one pass of an
+ * Aho-Corasick automaton. Matching never compiles anything and is safe to run
+ * from several threads on the same object.
+ */
+class CompiledQuery
+{
+public:
+    CompiledQuery() = default;
+    CompiledQuery(Expression query, bool isCaseSensitive, bool isRegex);
+
+    bool matches(QStringView prompt) const;
+
+    const Expression& expression() const;
+    bool isCaseSensitive() const;
+    bool isRegex() const;
+
+    bool isValid() const;
+    QString errorString() const;
+
+private:
+    struct Term
+    {
+        QStringMatcher matcher;
+        QRegularExpression regex;
+    };
+
+    struct Node
+    {
+        Operator op = Operator::NIL;
+        int term = -1;
+        QList<int> children;
+    };
+
+    int compile(const Expression& expr, Expression::NodeId node);
+    Term compileTerm(const QString& term) const;
+    bool termMatches(int term, QStringView prompt) const;
+
+    template <typename TermTest>
+    bool evaluate(int node, TermTest& test) const;
+
+    std::shared_ptr<const Expression> m_Expression = std::make_shared<const Expression>();
+    QStringList m_TermTexts;
+    QList<Term> m_Terms;
+    QList<Node> m_Nodes;
+    int m_Root = -1;
+    std::optional<AhoCorasick> m_Automaton;
+    bool m_IsCaseSensitive = false;
+    bool m_IsRegex = false;
+};
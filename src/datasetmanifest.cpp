@@ -0,0 +1,257 @@
+#include "datasetmanifest.hpp"
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtConcurrent/QtConcurrent>
+
+#include "helmdirectoryindex.hpp"
+#include "trace.hpp"
+
+namespace {
+    constexpr quint32 manifestMagic = 0x4850424D; // "HPBM"
+    constexpr quint32 manifestVersion = 2;
+    constexpr QDataStream::Version streamVersion = QDataStream::Qt_6_0;
+} // namespace
+
+/**
+ * @brief Sets the file the manifest is kept in; an empty path disables it.
+ */
+void DatasetManifest::setManifestFile(const QString& manifestFile)
+{
+    m_File = manifestFile;
+}
+
+/**
+ * @brief Brings the manifest up to date with the given HELM data root.
+ *
+ * A different root is first looked up in the manifest file. The root is only
+ * listed again when its modification time differs from the recorded one, and
+ * then only the run directories that were not recorded yet are read. The
+ * manifest file is rewritten after every listing.
+ *
+ * @param helmDataPath The base path for Helm data.
+ * @return bool False if the path is not a readable directory.
+ */
+bool DatasetManifest::update(const QString& helmDataPath)
+{
+    const TraceSpan span("DatasetManifest::update", helmDataPath);
+
+    if (helmDataPath != m_Root) {
+        m_Root = helmDataPath;
+        m_RootModified = -1;
+        m_RunDirs.clear();
+        load(helmDataPath);
+    }
+
+    const QFileInfo rootInfo(helmDataPath);
+    if (helmDataPath.isEmpty() || !rootInfo.isDir()) {
+        m_RootModified = -1;
+        m_RunDirs.clear();
+        return false;
+    }
+
+    const qint64 modified = rootInfo.lastModified().toMSecsSinceEpoch();
+    if (modified == m_RootModified) {
+        return true;
+    }
+
+    QStringList names = QDir(helmDataPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::NoSort);
+    std::sort(names.begin(), names.end());
+
+    // keep the records of the directories that are still there, read the others
+    QList<RunDir> runDirs;
+    runDirs.reserve(names.size());
+    QStringList added;
+    QList<qsizetype> addedAt;
+    auto known = m_RunDirs.cbegin();
+    for (const QString& name : std::as_const(names)) {
+        while (known != m_RunDirs.cend() && known->name < name) {
+            ++known;
+        }
+        if (known != m_RunDirs.cend() && known->name == name) {
+            runDirs.push_back(*known);
+            continue;
+        }
+        addedAt.push_back(runDirs.size());
+        added.push_back(name);
+        runDirs.push_back({ name, QString(), -1 });
+    }
+
+    const QList<RunDir> read = QtConcurrent::blockingMapped<QList<RunDir>>(added, [&helmDataPath](const QString& runDir) {
+        return readRunDir(helmDataPath, runDir);
+    });
+    for (qsizetype i = 0; i < addedAt.size(); ++i) {
+        runDirs[addedAt.at(i)] = read.at(i);
+    }
+
+    m_RunDirs = std::move(runDirs);
+    m_RootModified = modified;
+    save();
+    return true;
+}
+
+/**
+ * @brief Lists the datasets of the root with the known models they were evaluated on.
+ *
+ * @return QList<Dataset> The datasets, sorted by name.
+ */
+QList<DatasetManifest::Dataset> DatasetManifest::datasets() const
+{
+    QMap<QString, HPB::ModelSet> modelsByDataset;
+    for (const RunDir& runDir : m_RunDirs) {
+        if (runDir.dataset.isEmpty()) {
+            // not a run directory
+            continue;
+        }
+        HPB::ModelSet& models = modelsByDataset[runDir.dataset];
+        if (runDir.model >= 0) {
+            models.set(static_cast<size_t>(runDir.model));
+        }
+    }
+
+    QList<Dataset> datasets;
+    datasets.reserve(modelsByDataset.size());
+    for (const auto [name, models] : modelsByDataset.asKeyValueRange()) {
+        datasets.push_back({ name, models });
+    }
+    return datasets;
+}
+
+/**
+ * @brief Derives the task a dataset belongs to, under which it is listed in the dataset tree.
+ *
+ * @param dataset The dataset name, e.g. `mmlu:subject=anatomy,method=multiple_choice_joint`.
+ * @return QString The name up to its first argument, e.g. `mmlu`.
+ */
+QString DatasetManifest::taskName(const QString& dataset)
+{
+    const auto end = std::find_if(dataset.cbegin(), dataset.cend(), [](const QChar c) { return c == ':' || c == ','; });
+    return dataset.left(end - dataset.cbegin());
+}
+
+/***********
+ * Helpers *
+ ***********/
+
+/**
+ * @brief Reads the manifest file, if it describes the given root.
+ *
+ * @return bool True if the manifest was read.
+ */
+bool DatasetManifest::load(const QString& helmDataPath)
+{
+    QFile file(m_File);
+    if (m_File.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    const QByteArray data = mapped != nullptr ? QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), fileSize) : file.readAll();
+
+    QDataStream stream(data);
+    stream.setVersion(streamVersion);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString root;
+    qint64 rootModified = -1;
+    quint32 count = 0;
+    stream >> magic >> version >> root >> rootModified >> count;
+    if (stream.status() != QDataStream::Ok || magic != manifestMagic || version != manifestVersion || root != helmDataPath) {
+        return false;
+    }
+
+    QList<RunDir> runDirs;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        RunDir runDir;
+        stream >> runDir.name >> runDir.dataset >> runDir.model;
+        runDirs.push_back(std::move(runDir));
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_RunDirs = std::move(runDirs);
+    m_RootModified = rootModified;
+    return true;
+}
+
+bool DatasetManifest::save() const
+{
+    if (m_File.isEmpty() || !QDir().mkpath(QFileInfo(m_File).absolutePath())) {
+        return false;
+    }
+
+    QSaveFile file(m_File);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(streamVersion);
+    stream << manifestMagic << manifestVersion << m_Root << m_RootModified << static_cast<quint32>(m_RunDirs.size());
+    for (const RunDir& runDir : m_RunDirs) {
+        stream << runDir.name << runDir.dataset << runDir.model;
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+/**
+ * @brief Finds the dataset and the model a run directory was evaluated on.
+ *
+ * Both are taken from the directory's `run_spec.json`: the dataset from its
+ * `name`, and the model from `adapter_spec.model`. Without such a file, they are
+ * derived from the directory name.
+ *
+ * @param helmDataPath The base path for Helm data.
+ * @param runDir The run directory name.
+ * @return RunDir The record of the directory; its dataset is empty if it is not a run directory,
+ *         and its model is -1 if it is not one of HPB::Models.
+ */
+DatasetManifest::RunDir DatasetManifest::readRunDir(const QString& helmDataPath, const QString& runDir)
+{
+    static const QHash<QString, qint16> modelIds = [] {
+        QHash<QString, qint16> ids;
+        for (const LanguageModel& model : HPB::Models) {
+            ids.insert(QString::fromLatin1(model.name()), static_cast<qint16>(model.id()));
+        }
+        return ids;
+    }();
+
+    QString runName = runDir;
+    QString model;
+    QFile runSpecFile(QDir(helmDataPath).filePath(runDir + "/run_spec.json"));
+    if (runSpecFile.open(QIODevice::ReadOnly)) {
+        const QJsonObject runSpec = QJsonDocument::fromJson(runSpecFile.readAll()).object();
+        if (const QString name = runSpec["name"].toString(); !name.isEmpty()) {
+            runName = name;
+        }
+        model = runSpec["adapter_spec"].toObject()["model"].toString();
+        // run directories and HPB::Models spell "vendor/model" as "vendor_model"
+        model.replace('/', '_');
+    }
+
+    if (model.isEmpty()) {
+        const qsizetype from = runName.indexOf("model=");
+        if (from >= 0) {
+            const qsizetype to = runName.indexOf(',', from);
+            model = runName.mid(from + 6, to < 0 ? -1 : to - from - 6);
+        }
+    }
+
+    const QString dataset = HelmDirectoryIndex::datasetKey(runName);
+    return { runDir, dataset != runName ? dataset : QString(), modelIds.value(model, -1) };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include "languagemodel.hpp"
+
+/*
+ * Dataset manifest file layout (QDataStream, Qt 6.0 format):
+ *
+ *   quint32  magic ("HPBM")
+ *   quint32  format version
+ *   QString  HELM data root
+ *   qint64   modification time of the root, in ms since epoch
+ *   quint32  run directory count
+ *   records  run directory name, dataset name (empty for other directories),
+ *            model id (qint16, -1 for unknown models), sorted by directory name
+ *
+ * A manifest is valid only for the root it records, and up to date only while
+ * the modification time of the root matches the recorded one.
+ */
+
+/**
+ * @brief The datasets and evaluated models found under a HELM data root.
+ *
+ * Every run directory is one evaluation of a dataset on a model: the dataset is
+ * the run name without its `model=` argument, and both are read from the
+ * directory's `run_spec.json`. The run name is used rather than the directory
+ * name, which has ':' written as '_' on Windows. Reading those files is the
+ * expensive part of the scan, so the result is kept in a manifest file that
+ * later updates map and reuse; when the root changes, only the run directories
+ * added since the last scan are read.
+ */
+class DatasetManifest
+{
+public:
+    /**
+     * @brief A dataset and the known models it was evaluated on.
+     */
+    struct Dataset
+    {
+        QString name;
+        HPB::ModelSet models;
+    };
+
+    void setManifestFile(const QString& manifestFile);
+    bool update(const QString& helmDataPath);
+
+    QList<Dataset> datasets() const;
+    static QString taskName(const QString& dataset);
+
+private:
+    struct RunDir
+    {
+        QString name;
+        QString dataset;
+        qint16 model = -1;
+    };
+
+    bool load(const QString& helmDataPath);
+    bool save() const;
+    static RunDir readRunDir(const QString& helmDataPath, const QString& runDir);
+
+    QString m_File;
+    QString m_Root;
+    qint64 m_RootModified = -1;
+    QList<RunDir> m_RunDirs;
+};
@@ -0,0 +1,61 @@
+#include "helmdataconfig.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+/**
+ * @brief Brings the index up to date with a `helm_tests.json` file.
+ *
+ * The file is expected to hold arrays of objects with `name`, `metric` and
+ * `split` members; when a name appears more than once, the last entry wins.
+ *
+ * @param fileName Path to the JSON file containing the Helm dataset configuration.
+ * @return bool False if the file cannot be read or lists no dataset.
+ */
+bool HelmDataConfig::update(const QString& fileName)
+{
+    const QFileInfo info(fileName);
+    if (fileName == m_File && info.exists() && info.size() == m_Size && info.lastModified() == m_Modified) {
+        return !m_Datasets.isEmpty();
+    }
+
+    m_File = fileName;
+    m_Size = info.size();
+    m_Modified = info.lastModified();
+    m_Datasets.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_Size = -1;
+        return false;
+    }
+
+    const QJsonObject config = QJsonDocument::fromJson(file.readAll()).object();
+    for (const auto& array : config) {
+        for (const auto& value : array.toArray()) {
+            const QJsonObject dataset = value.toObject();
+            m_Datasets.insert(dataset["name"].toString(), { dataset["metric"].toString(), dataset["split"].toString() });
+        }
+    }
+
+    return !m_Datasets.isEmpty();
+}
+
+/**
+ * @brief Looks up the metric and split of a (sub)dataset.
+ *
+ * @param dataset The dataset name, including its specification.
+ * @return HelmDatasetInfo The metadata; empty if the dataset is not listed.
+ */
+HelmDatasetInfo HelmDataConfig::find(const QString& dataset) const
+{
+    return m_Datasets.value(dataset);
+}
+
+bool HelmDataConfig::isEmpty() const
+{
+    return m_Datasets.isEmpty();
+}
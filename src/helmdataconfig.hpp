@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief The HELM metadata of a dataset exported with a compilation.
+ */
+struct HelmDatasetInfo {
+    QString metric;
+    QString split;
+};
+
+/**
+ * @brief PNYX's `helm_tests.json`, indexed by dataset name.
+ *
+ * The file is parsed once into a hash from dataset name to metadata, so that an
+ * export looks each (sub)dataset up in constant time. update() parses it again
+ * only when its path, size or modification time changed.
+ */
+class HelmDataConfig
+{
+public:
+    bool update(const QString& fileName);
+
+    HelmDatasetInfo find(const QString& dataset) const;
+    bool isEmpty() const;
+
+private:
+    QString m_File;
+    qint64 m_Size = -1;
+    QDateTime m_Modified;
+    QHash<QString, HelmDatasetInfo> m_Datasets;
+};
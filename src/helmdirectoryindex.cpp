@@ -0,0 +1,163 @@
+#include "helmdirectoryindex.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSysInfo>
+
+#include "trace.hpp"
+
+/**
+ * @brief Brings the index up to date with the given HELM data root.
+ *
+ * A different root is indexed from scratch. For the same root the directory is
+ * only listed again when its modification time changed, and then only the
+ * difference to the previous listing is applied.
+ *
+ * @param helmDataPath The base path for Helm data.
+ * @return bool False if the path is not a readable directory.
+ */
+bool HelmDirectoryIndex::update(const QString& helmDataPath)
+{
+    const TraceSpan span("HelmDirectoryIndex::update", helmDataPath);
+
+    if (helmDataPath != m_Root) {
+        m_Root = helmDataPath;
+        m_RootModified = QDateTime();
+        m_RunDirs.clear();
+        m_RunDirsByDataset.clear();
+    }
+
+    const QFileInfo rootInfo(helmDataPath);
+    if (helmDataPath.isEmpty() || !rootInfo.isDir()) {
+        m_RootModified = QDateTime();
+        m_RunDirs.clear();
+        m_RunDirsByDataset.clear();
+        return false;
+    }
+
+    const QDateTime modified = rootInfo.lastModified();
+    if (m_RootModified.isValid() && modified == m_RootModified) {
+        return true;
+    }
+
+    QStringList runDirs = QDir(helmDataPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::NoSort);
+    std::sort(runDirs.begin(), runDirs.end());
+
+    QStringList removed;
+    QStringList added;
+    std::set_difference(m_RunDirs.cbegin(), m_RunDirs.cend(), runDirs.cbegin(), runDirs.cend(), std::back_inserter(removed));
+    std::set_difference(runDirs.cbegin(), runDirs.cend(), m_RunDirs.cbegin(), m_RunDirs.cend(), std::back_inserter(added));
+
+    for (const QString& runDir : std::as_const(removed)) {
+        remove(runDir);
+    }
+    for (const QString& runDir : std::as_const(added)) {
+        insert(runDir);
+    }
+
+    m_RunDirs = std::move(runDirs);
+    m_RootModified = modified;
+    return true;
+}
+
+/**
+ * @brief Returns the run directory holding the instances of a dataset.
+ *
+ * @param dataset The dataset name.
+ * @return QString The first matching run directory in name order, or an empty string if there is none.
+ */
+QString HelmDirectoryIndex::taskDir(const QString& dataset) const
+{
+    const QStringList runDirs = taskDirs(dataset);
+    return runDirs.isEmpty() ? QString() : runDirs.first();
+}
+
+/**
+ * @brief Returns all run directories of a dataset, one per evaluated model.
+ *
+ * Names that do not follow the usual `<dataset>,model=<model>` pattern are
+ * resolved by a binary search for directories starting with the dataset name.
+ *
+ * @param dataset The dataset name.
+ * @return QStringList The matching run directories in name order.
+ */
+QStringList HelmDirectoryIndex::taskDirs(const QString& dataset) const
+{
+    const QString name = normalizedDatasetName(dataset);
+
+    const auto it = m_RunDirsByDataset.constFind(name);
+    if (it != m_RunDirsByDataset.cend()) {
+        return it.value();
+    }
+
+    QStringList runDirs;
+    for (auto dir = std::lower_bound(m_RunDirs.cbegin(), m_RunDirs.cend(), name);
+         dir != m_RunDirs.cend() && dir->startsWith(name);
+         ++dir) {
+        runDirs.push_back(*dir);
+    }
+    return runDirs;
+}
+
+const QString& HelmDirectoryIndex::root() const
+{
+    return m_Root;
+}
+
+qsizetype HelmDirectoryIndex::size() const
+{
+    return m_RunDirs.size();
+}
+
+/**
+ * @brief Derives the dataset a run directory belongs to.
+ *
+ * @param runDir The run directory name, e.g. `babi_qa:task=15,model=openai_gpt-4-0613`.
+ * @return QString The name without the `model=` argument and the ones after it, e.g. `babi_qa:task=15`.
+ */
+QString HelmDirectoryIndex::datasetKey(const QString& runDir)
+{
+    qsizetype from = 0;
+    while ((from = runDir.indexOf("model=", from)) > 0) {
+        const QChar separator = runDir.at(from - 1);
+        if (separator == ',' || separator == ':') {
+            return runDir.left(from - 1);
+        }
+        ++from;
+    }
+    return runDir;
+}
+
+/**
+ * @brief Converts a dataset name to the form used in directory names on this OS.
+ *
+ * @param dataset The dataset name.
+ * @return QString The name with ':' replaced by '_' on Windows, unchanged elsewhere.
+ */
+QString HelmDirectoryIndex::normalizedDatasetName(const QString& dataset)
+{
+    static const bool isWindows = QSysInfo::productType() == "windows";
+    return isWindows ? QString(dataset).replace(":", "_") : dataset;
+}
+
+void HelmDirectoryIndex::insert(const QString& runDir)
+{
+    QStringList& runDirs = m_RunDirsByDataset[datasetKey(runDir)];
+    runDirs.insert(std::lower_bound(runDirs.begin(), runDirs.end(), runDir), runDir);
+}
+
+void HelmDirectoryIndex::remove(const QString& runDir)
+{
+    const QString key = datasetKey(runDir);
+    const auto it = m_RunDirsByDataset.find(key);
+    if (it == m_RunDirsByDataset.end()) {
+        return;
+    }
+    it.value().removeOne(runDir);
+    if (it.value().isEmpty()) {
+        m_RunDirsByDataset.erase(it);
+    }
+}
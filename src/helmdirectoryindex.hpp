@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Index of the run directories under a HELM data root.
+ *
+ * The root is listed once and every run directory is filed under the dataset
+ * name it belongs to, i.e. its name with the `model=` argument and everything
+ * after it removed. Resolving the directory of a dataset is then a hash lookup
+ * instead of a filtered listing of the whole root.
+ *
+ * update() re-lists the root only when its modification time changed, and then
+ * only files the directories that were added or removed since the last listing.
+ */
+class HelmDirectoryIndex
+{
+public:
+    bool update(const QString& helmDataPath);
+
+    QString taskDir(const QString& dataset) const;
+    QStringList taskDirs(const QString& dataset) const;
+
+    const QString& root() const;
+    qsizetype size() const;
+
+    static QString datasetKey(const QString& runDir);
+
+private:
+    static QString normalizedDatasetName(const QString& dataset);
+
+    void insert(const QString& runDir);
+    void remove(const QString& runDir);
+
+    QString m_Root;
+    QDateTime m_RootModified;
+    QStringList m_RunDirs;
+    QHash<QString, QStringList> m_RunDirsByDataset;
+};
@@ -0,0 +1,291 @@
+#include "instancecache.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include "trace.hpp"
+
+namespace {
+    constexpr quint32 cacheMagic = 0x48504243; // "HPBC"
+    constexpr quint32 cacheVersion = 1;
+    constexpr qint64 headerCountOffset = 24;
+    constexpr QDataStream::Version streamVersion = QDataStream::Qt_6_0;
+
+    qint64 modificationTime(const QFileInfo& file)
+    {
+        return file.lastModified().toMSecsSinceEpoch();
+    }
+
+    void writeInstance(QDataStream& stream, const TaskInstance& instance)
+    {
+        stream << instance.id << instance.input << instance.hasSubSplit << instance.subSplit << instance.isPerturbed;
+        stream << static_cast<quint32>(instance.references.size());
+        for (const InstanceReference& reference : instance.references) {
+            stream << reference.text << reference.tags;
+        }
+    }
+
+    bool readInstance(QDataStream& stream, TaskInstance& instance)
+    {
+        quint32 referenceCount = 0;
+        stream >> instance.id >> instance.input >> instance.hasSubSplit >> instance.subSplit >> instance.isPerturbed;
+        stream >> referenceCount;
+        if (stream.status() != QDataStream::Ok) {
+            return false;
+        }
+
+        instance.references.clear();
+        for (quint32 i = 0; i < referenceCount && stream.status() == QDataStream::Ok; ++i) {
+            InstanceReference reference;
+            stream >> reference.text >> reference.tags;
+            instance.references.push_back(std::move(reference));
+        }
+
+        return stream.status() == QDataStream::Ok;
+    }
+} // namespace
+
+/**
+ * @brief Computes the cache file used for a task's instances.
+ *
+ * @param cachePath The root of the cache directory.
+ * @param instancesFile Path to the task's `instances.json`.
+ * @return QString Path of the cache file, named after a hash of the source path.
+ */
+QString InstanceCache::cacheFileFor(const QString& cachePath, const QString& instancesFile)
+{
+    const QByteArray key = QFileInfo(instancesFile).absoluteFilePath().toUtf8();
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return QDir(cachePath).filePath("instances/" + name + ".hpbc");
+}
+
+/************************
+ * CachedInstanceReader *
+ ************************/
+
+CachedInstanceReader::CachedInstanceReader(const QString& cacheFile, const QString& instancesFile)
+    : m_File(cacheFile), m_InstancesFile(instancesFile)
+{}
+
+CachedInstanceReader::~CachedInstanceReader()
+{
+    m_Stream.setDevice(nullptr);
+    if (m_Mapped) {
+        m_File.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_Data.constData())));
+    }
+}
+
+/**
+ * @brief Opens the cache file and checks it against its source.
+ *
+ * @return bool True if the cache exists, is well-formed and is up to date.
+ */
+bool CachedInstanceReader::open()
+{
+    const TraceSpan span("CachedInstanceReader::open", m_File.fileName());
+
+    if (!m_File.exists() || !m_File.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = m_File.size();
+    uchar* mapped = fileSize > 0 ? m_File.map(0, fileSize) : nullptr;
+    if (mapped != nullptr) {
+        m_Data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), fileSize);
+        m_Mapped = true;
+    }
+    else {
+        m_Data = m_File.readAll();
+    }
+
+    m_Buffer.setData(m_Data);
+    m_Buffer.open(QIODevice::ReadOnly);
+    m_Stream.setDevice(&m_Buffer);
+    m_Stream.setVersion(streamVersion);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 sourceMtime = 0;
+    m_Stream >> magic >> version >> m_SourceSize >> sourceMtime >> m_Count >> m_TableOffset;
+
+    if (m_Stream.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion) {
+        return false;
+    }
+
+    const QFileInfo source(m_InstancesFile);
+    return source.exists() && source.size() == m_SourceSize && modificationTime(source) == sourceMtime;
+}
+
+/**
+ * @brief Limits reading to the given records, e.g. the candidates from a PromptIndex.
+ *
+ * @param indices Ascending record indices.
+ */
+void CachedInstanceReader::restrictTo(const QList<quint32>& indices)
+{
+    m_Selection = indices;
+    m_SelectionIndex = 0;
+}
+
+bool CachedInstanceReader::next(TaskInstance& instance)
+{
+    if (m_Selection) {
+        if (m_SelectionIndex >= m_Selection->size() || !seek(m_Selection->at(m_SelectionIndex))) {
+            return false;
+        }
+        ++m_SelectionIndex;
+    }
+    if (m_Index >= m_Count) {
+        return false;
+    }
+    if (!readInstance(m_Stream, instance)) {
+        m_Error = "corrupt instance cache " + m_File.fileName();
+        m_Index = m_Count;
+        return false;
+    }
+    instance.index = m_Index++;
+    return true;
+}
+
+qint64 CachedInstanceReader::position() const
+{
+    if (m_Selection) {
+        return m_Selection->isEmpty() ? m_SourceSize : m_SourceSize * m_SelectionIndex / m_Selection->size();
+    }
+    return m_Count == 0 ? m_SourceSize : m_SourceSize * m_Index / m_Count;
+}
+
+qint64 CachedInstanceReader::size() const
+{
+    return m_SourceSize;
+}
+
+const QString& CachedInstanceReader::errorString() const
+{
+    return m_Error;
+}
+
+/**
+ * @brief Positions the stream on a record using the offset table.
+ *
+ * @param index The record index.
+ * @return bool False if the index or its offset is out of range.
+ */
+bool CachedInstanceReader::seek(const quint32 index)
+{
+    if (index >= m_Count || !m_Buffer.seek(m_TableOffset + qint64(index) * qint64(sizeof(qint64)))) {
+        m_Error = "corrupt instance cache " + m_File.fileName();
+        return false;
+    }
+
+    qint64 offset = 0;
+    m_Stream >> offset;
+    if (m_Stream.status() != QDataStream::Ok || offset >= m_TableOffset || !m_Buffer.seek(offset)) {
+        m_Error = "corrupt instance cache " + m_File.fileName();
+        return false;
+    }
+
+    m_Index = index;
+    return true;
+}
+
+/***********************
+ * InstanceCacheWriter *
+ ***********************/
+
+InstanceCacheWriter::InstanceCacheWriter(const QString& cacheFile, const QString& instancesFile)
+    : m_File(cacheFile), m_InstancesFile(instancesFile)
+{}
+
+bool InstanceCacheWriter::open()
+{
+    if (!QDir().mkpath(QFileInfo(m_File.fileName()).absolutePath())) {
+        return false;
+    }
+    if (!m_File.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    m_Stream.setDevice(&m_File);
+    m_Stream.setVersion(streamVersion);
+
+    // size and time are taken before reading, so a source modified meanwhile invalidates the entry
+    const QFileInfo source(m_InstancesFile);
+    m_Stream << cacheMagic << cacheVersion << source.size() << modificationTime(source);
+    m_Stream << quint32(0) << qint64(0);
+
+    return m_Stream.status() == QDataStream::Ok;
+}
+
+void InstanceCacheWriter::append(const TaskInstance& instance)
+{
+    m_Offsets.push_back(m_File.pos());
+    writeInstance(m_Stream, instance);
+}
+
+bool InstanceCacheWriter::commit()
+{
+    const qint64 tableOffset = m_File.pos();
+    for (const qint64 offset : std::as_const(m_Offsets)) {
+        m_Stream << offset;
+    }
+
+    m_File.seek(headerCountOffset);
+    m_Stream << static_cast<quint32>(m_Offsets.size()) << tableOffset;
+
+    if (m_Stream.status() != QDataStream::Ok) {
+        m_File.cancelWriting();
+        return false;
+    }
+    return m_File.commit();
+}
+
+/*************************
+ * CachingInstanceReader *
+ *************************/
+
+CachingInstanceReader::CachingInstanceReader(std::unique_ptr<InstanceReader> source, const QString& cacheFile, const QString& instancesFile, const bool buildIndex)
+    : m_Source(std::move(source)), m_Writer(cacheFile, instancesFile)
+{
+    m_Writing = m_Writer.open();
+    if (m_Writing && buildIndex) {
+        m_IndexWriter = std::make_unique<PromptIndexWriter>(PromptIndex::indexFileFor(cacheFile), instancesFile);
+    }
+}
+
+bool CachingInstanceReader::next(TaskInstance& instance)
+{
+    if (m_Source->next(instance)) {
+        if (m_Writing) {
+            m_Writer.append(instance);
+            if (m_IndexWriter) {
+                m_IndexWriter->append(instance);
+            }
+        }
+        return true;
+    }
+
+    if (m_Writing && m_Source->errorString().isEmpty() && m_Writer.commit() && m_IndexWriter) {
+        m_IndexWriter->commit();
+    }
+    m_Writing = false;
+    m_IndexWriter.reset();
+    return false;
+}
+
+qint64 CachingInstanceReader::position() const
+{
+    return m_Source->position();
+}
+
+qint64 CachingInstanceReader::size() const
+{
+    return m_Source->size();
+}
+
+const QString& CachingInstanceReader::errorString() const
+{
+    return m_Source->errorString();
+}
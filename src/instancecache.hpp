@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+
+#include "instancereader.hpp"
+#include "promptindex.hpp"
+#include "taskinstance.hpp"
+
+/*
+ * Binary instance cache file layout (QDataStream, Qt 6.0 format):
+ *
+ *   quint32  magic ("HPBC")
+ *   quint32  format version
+ *   qint64   size of the source instances.json
+ *   qint64   modification time of the source, in ms since epoch
+ *   quint32  instance count
+ *   qint64   file offset of the record table
+ *   records  id, input, hasSubSplit, subSplit, isPerturbed, references
+ *   table    one qint64 file offset per record
+ *
+ * A cache file is valid only while the size and modification time of its
+ * source match the ones recorded in its header.
+ */
+
+namespace InstanceCache {
+    QString cacheFileFor(const QString& cachePath, const QString& instancesFile);
+} // namespace InstanceCache
+
+/**
+ * @brief Reads the instances of a task from its binary cache file.
+ */
+class CachedInstanceReader : public InstanceReader
+{
+public:
+    CachedInstanceReader(const QString& cacheFile, const QString& instancesFile);
+    ~CachedInstanceReader() override;
+
+    bool open();
+    void restrictTo(const QList<quint32>& indices);
+    bool next(TaskInstance& instance) override;
+
+    qint64 position() const override;
+    qint64 size() const override;
+    const QString& errorString() const override;
+
+private:
+    bool seek(quint32 index);
+
+    QFile m_File;
+    QString m_InstancesFile;
+    QByteArray m_Data;
+    QBuffer m_Buffer;
+    QDataStream m_Stream;
+    bool m_Mapped = false;
+    quint32 m_Count = 0;
+    quint32 m_Index = 0;
+    qint64 m_TableOffset = 0;
+    qint64 m_SourceSize = 0;
+    std::optional<QList<quint32>> m_Selection;
+    qsizetype m_SelectionIndex = 0;
+    QString m_Error;
+};
+
+/**
+ * @brief Writes a binary cache file while instances are being read from JSON.
+ *
+ * The file is written through a QSaveFile, so a cache entry only appears once
+ * commit() succeeds; an abandoned writer leaves no partial file behind.
+ */
+class InstanceCacheWriter
+{
+public:
+    InstanceCacheWriter(const QString& cacheFile, const QString& instancesFile);
+
+    bool open();
+    void append(const TaskInstance& instance);
+    bool commit();
+
+private:
+    QSaveFile m_File;
+    QString m_InstancesFile;
+    QDataStream m_Stream;
+    QList<qint64> m_Offsets;
+};
+
+/**
+ * @brief Passes instances through from a JSON reader and caches them on the way.
+ *
+ * The cache entry, and optionally the task's full-text index, are committed once
+ * the source has been read to the end without errors; a reader abandoned halfway
+ * (e.g. on cancellation) writes nothing.
+ */
+class CachingInstanceReader : public InstanceReader
+{
+public:
+    CachingInstanceReader(std::unique_ptr<InstanceReader> source, const QString& cacheFile, const QString& instancesFile, bool buildIndex = false);
+
+    bool next(TaskInstance& instance) override;
+
+    qint64 position() const override;
+    qint64 size() const override;
+    const QString& errorString() const override;
+
+private:
+    std::unique_ptr<InstanceReader> m_Source;
+    InstanceCacheWriter m_Writer;
+    std::unique_ptr<PromptIndexWriter> m_IndexWriter;
+    bool m_Writing = false;
+};
@@ -0,0 +1,189 @@
+#include "instancereader.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include "trace.hpp"
+
+JsonInstanceReader::JsonInstanceReader(const QString& fileName)
+    : m_File(fileName)
+{}
+
+JsonInstanceReader::~JsonInstanceReader()
+{
+    if (m_Buffer.isEmpty() && m_Data != nullptr) {
+        m_File.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_Data)));
+    }
+}
+
+/**
+ * @brief Opens and maps the instances file and positions the reader on the first instance.
+ *
+ * If the file cannot be mapped (e.g. on some network file systems) it is read into
+ * memory instead, which keeps the reader usable at the cost of the memory savings.
+ *
+ * @return bool True if the file is readable and starts with a JSON array.
+ */
+bool JsonInstanceReader::open()
+{
+    const TraceSpan span("JsonInstanceReader::open", m_File.fileName());
+
+    if (!m_File.open(QIODevice::ReadOnly)) {
+        m_Error = m_File.errorString();
+        return false;
+    }
+
+    m_Size = m_File.size();
+    if (m_Size > 0) {
+        uchar* mapped = m_File.map(0, m_Size);
+        if (mapped != nullptr) {
+            m_Data = reinterpret_cast<const char*>(mapped);
+        }
+        else {
+            m_Buffer = m_File.readAll();
+            m_Data = m_Buffer.constData();
+            m_Size = m_Buffer.size();
+        }
+    }
+
+    m_Pos = 0;
+    skipWhitespace();
+    if (m_Pos >= m_Size || m_Data[m_Pos] != '[') {
+        m_Error = "instances file is not a JSON array";
+        return false;
+    }
+    ++m_Pos;
+
+    return true;
+}
+
+/**
+ * @brief Limits reading to the given instances; the others are skipped without being parsed.
+ *
+ * @param indices Ascending instance indices.
+ */
+void JsonInstanceReader::restrictTo(const QList<quint32>& indices)
+{
+    m_Selection = indices;
+    m_SelectionIndex = 0;
+}
+
+/**
+ * @brief Parses the next instance in the file.
+ *
+ * @param instance Receives the parsed instance.
+ * @return bool False at the end of the array or on a parse error (see errorString()).
+ */
+bool JsonInstanceReader::next(TaskInstance& instance)
+{
+    QByteArrayView object;
+    if (m_Selection) {
+        if (m_SelectionIndex >= m_Selection->size()) {
+            m_Pos = m_Size;
+            return false;
+        }
+        const quint32 wanted = m_Selection->at(m_SelectionIndex++);
+        while (m_Index < wanted && nextObject(object)) {
+            ++m_Index;
+        }
+    }
+    if (!nextObject(object)) {
+        return false;
+    }
+
+    const TraceSpan span("parseInstance", TraceSpan::PerItem);
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(object.data(), object.size()), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        m_Error = error.errorString();
+        m_Pos = m_Size;
+        return false;
+    }
+
+    instance = TaskInstance::fromJson(doc.object());
+    instance.index = m_Index++;
+    return true;
+}
+
+qint64 JsonInstanceReader::position() const
+{
+    return m_Pos;
+}
+
+qint64 JsonInstanceReader::size() const
+{
+    return m_Size;
+}
+
+const QString& JsonInstanceReader::errorString() const
+{
+    return m_Error;
+}
+
+void JsonInstanceReader::skipWhitespace()
+{
+    while (m_Pos < m_Size) {
+        const char c = m_Data[m_Pos];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        ++m_Pos;
+    }
+}
+
+/**
+ * @brief Finds the byte span of the next element of the top-level array.
+ *
+ * Only braces and brackets outside of string literals are counted, so the scan
+ * never needs to decode the contents of the element.
+ *
+ * @param object Receives the span of the element, including its enclosing braces.
+ * @return bool False when the closing bracket of the array has been reached.
+ */
+bool JsonInstanceReader::nextObject(QByteArrayView& object)
+{
+    while (m_Pos < m_Size && m_Data[m_Pos] != '{') {
+        if (m_Data[m_Pos] == ']') {
+            m_Pos = m_Size;
+            return false;
+        }
+        ++m_Pos;
+    }
+    if (m_Pos >= m_Size) {
+        return false;
+    }
+
+    const qint64 begin = m_Pos;
+    int depth = 0;
+    bool inString = false;
+
+    for (; m_Pos < m_Size; ++m_Pos) {
+        const char c = m_Data[m_Pos];
+        if (inString) {
+            if (c == '\\') {
+                ++m_Pos;
+            }
+            else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        }
+        else if (c == '{' || c == '[') {
+            ++depth;
+        }
+        else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                ++m_Pos;
+                object = QByteArrayView(m_Data + begin, m_Pos - begin);
+                return true;
+            }
+        }
+    }
+
+    m_Error = "unterminated instance at end of file";
+    return false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <optional>
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include "taskinstance.hpp"
+
+/**
+ * @brief Sequential source of the instances of one HELM task.
+ *
+ * position() and size() are expressed in bytes of the task's `instances.json`,
+ * whatever the reader actually reads, so that progress can be aggregated across
+ * readers of different kinds.
+ */
+class InstanceReader
+{
+public:
+    InstanceReader() = default;
+    virtual ~InstanceReader() = default;
+
+    InstanceReader(const InstanceReader&) = delete;
+    InstanceReader& operator=(const InstanceReader&) = delete;
+
+    virtual bool next(TaskInstance& instance) = 0;
+
+    virtual qint64 position() const = 0;
+    virtual qint64 size() const = 0;
+    virtual const QString& errorString() const = 0;
+};
+
+/**
+ * @brief Pull reader over the top-level array of an `instances.json` file.
+ *
+ * The file is memory-mapped and scanned for the byte span of one array element
+ * at a time; only that element is handed to the JSON parser. Peak memory is
+ * therefore bounded by the largest instance, not by the size of the file.
+ */
+class JsonInstanceReader : public InstanceReader
+{
+public:
+    explicit JsonInstanceReader(const QString& fileName);
+    ~JsonInstanceReader() override;
+
+    bool open();
+    void restrictTo(const QList<quint32>& indices);
+    bool next(TaskInstance& instance) override;
+
+    qint64 position() const override;
+    qint64 size() const override;
+    const QString& errorString() const override;
+
+private:
+    bool nextObject(QByteArrayView& object);
+    void skipWhitespace();
+
+    QFile m_File;
+    QByteArray m_Buffer;
+    const char* m_Data = nullptr;
+    qint64 m_Size = 0;
+    qint64 m_Pos = 0;
+    quint32 m_Index = 0;
+    std::optional<QList<quint32>> m_Selection;
+    qsizetype m_SelectionIndex = 0;
+    QString m_Error;
+};
@@ -1,26 +1,30 @@
 #include "languagemodel.hpp"
 
-LanguageModel::LanguageModel(const int id, QString name, const double parameters)
-    : m_Id(id), m_Name(std::move(name)), m_Parameters(parameters)
-{}
+namespace HPB {
+    /**
+     * @brief The models of some vendors.
+     *
+     * @param vendors The vendors, as HPB::Vendor values.
+     * @return ModelSet The models of those vendors.
+     */
+    ModelSet modelsByVendor(const QList<int>& vendors)
+    {
+        ModelSet models;
+        for (size_t id = 0; id < ModelTable.size(); ++id) {
+            models[id] = ModelTable[id].evaluated && vendors.contains(static_cast<int>(ModelTable[id].vendor));
+        }
+        return models;
+    }
 
-const QString& LanguageModel::name() const
-{
-    return m_Name;
-}
-
-double LanguageModel::parameters() const
-{
-    return m_Parameters;
-}
-
-HPB::Vendor LanguageModel::vendor() const
-{
-    constexpr int base = 0x10;
-    return static_cast<HPB::Vendor>((m_Id / base) % base);
-}
-
-int LanguageModel::id() const
-{
-    return m_Id;
-}
+    /**
+     * @brief The models whose number of parameters is within [min, max).
+     */
+    ModelSet modelsBySize(const double min, const double max)
+    {
+        ModelSet models;
+        for (size_t id = 0; id < ModelTable.size(); ++id) {
+            models[id] = ModelTable[id].evaluated && ModelTable[id].parameters >= min && ModelTable[id].parameters < max;
+        }
+        return models;
+    }
+} // namespace HPB
@@ -1,19 +1,132 @@
 #pragma once
 
-#include <QString>
+#include <array>
+#include <bitset>
+
+#include <QList>
 
 #include "hpb_globals.hpp"
 
 class LanguageModel {
 public:
-    LanguageModel(int id, QString name, double parameters);
-    const QString& name() const;
-    double parameters() const;
-    HPB::Vendor vendor() const;
-    int id() const;
+    constexpr LanguageModel(const int id, const char* name, const double parameters)
+        : m_Id(id), m_Name(name), m_Parameters(parameters)
+    {}
+
+    constexpr const char* name() const { return m_Name; }
+    constexpr double parameters() const { return m_Parameters; }
+    constexpr HPB::Vendor vendor() const
+    {
+        constexpr int base = 0x10;
+        return static_cast<HPB::Vendor>((m_Id / base) % base);
+    }
+    constexpr int id() const { return m_Id; }
 
 private:
     int m_Id;
-    QString m_Name;
+    const char* m_Name;
     double m_Parameters;
 };
+
+namespace HPB {
+    /**
+     * @brief A set of language models; bit i stands for the model with id i.
+     */
+    using ModelSet = std::bitset<256>;
+
+    inline constexpr std::array Models = {
+        LanguageModel(0x00, "AlephAlpha_luminous-base", 13e9),
+        LanguageModel(0x01, "AlephAlpha_luminous-extended", 30e9),
+        LanguageModel(0x02, "AlephAlpha_luminous-supreme", 70e9),
+        LanguageModel(0x10, "ai21_j1-grande", 17e9),
+        LanguageModel(0x11, "ai21_j1-grande-v2-beta", 17e9),
+        LanguageModel(0x12, "ai21_j1-jumbo", 178e9),
+        LanguageModel(0x13, "ai21_j1-large", 7.5e9),
+        LanguageModel(0x14, "ai21_j2-grande", 17e9),
+        LanguageModel(0x15, "ai21_j2-jumbo", 178e9),
+        LanguageModel(0x16, "ai21_j2-large", 7.5e9),
+        LanguageModel(0x20, "anthropic_stanford-online-all-v4-s3", 52e9),
+        LanguageModel(0x30, "cohere_command-medium-beta", 6.1e9),
+        LanguageModel(0x31, "cohere_command-xlarge-beta", 52.4e9),
+        LanguageModel(0x32, "cohere_large-20220720", 13.1e9),
+        LanguageModel(0x33, "cohere_medium-20220720", 6.1e9),
+        LanguageModel(0x34, "cohere_medium-20221108", 6.1e9),
+        LanguageModel(0x35, "cohere_small-20220720", 410e6),
+        LanguageModel(0x36, "cohere_xlarge-20220609", 52.4e9),
+        LanguageModel(0x37, "cohere_xlarge-20221108", 52.4e9),
+        LanguageModel(0x40, "eleutherai_pythia-12b-v0", 12e9),
+        LanguageModel(0x41, "eleutherai_pythia-1b-v0", 1e9),
+        LanguageModel(0x42, "eleutherai_pythia-6.9b", 6.9e9),
+        LanguageModel(0x50, "lmsys_vicuna-13b-v1.3", 13e9),
+        LanguageModel(0x51, "lmsys_vicuna-7b-v1.3", 7e9),
+        LanguageModel(0x60, "meta_llama-13b", 13e9),
+        LanguageModel(0x61, "meta_llama-2-13b", 13e9),
+        LanguageModel(0x62, "meta_llama-2-70b", 70e9),
+        LanguageModel(0x63, "meta_llama-2-7b", 7e9),
+        LanguageModel(0x64, "meta_llama-30b", 30e9),
+        LanguageModel(0x65, "meta_llama-65b", 65e9),
+        LanguageModel(0x66, "meta_llama-7b", 7e9),
+        LanguageModel(0x70, "microsoft_TNLGv2_530B", 530e9),
+        LanguageModel(0x71, "microsoft_TNLGv2_7B", 7e9),
+        LanguageModel(0x80, "mistralai_mistral-7b-v0.1", 7e9),
+        LanguageModel(0x90, "mosaicml_mpt-30b", 30e9),
+        LanguageModel(0x91, "mosaicml_mpt-instruct-30b", 30e9),
+        LanguageModel(0xA0, "openai_ada", 350e6),
+        LanguageModel(0xA1, "openai_babbage", 1.3e9),
+        LanguageModel(0xA2, "openai_code-cushman-001", 12e9),
+        LanguageModel(0xA3, "openai_code-davinci-002", 175e9),
+        LanguageModel(0xA4, "openai_curie", 6.7e9),
+        LanguageModel(0xA5, "openai_davinci", 175e9),
+        LanguageModel(0xA6, "openai_gpt-3.5-turbo-0301", 20e9),
+        LanguageModel(0xA7, "openai_gpt-3.5-turbo-0613", 2e9),
+        LanguageModel(0xA8, "openai_text-ada-001", 350e6),
+        LanguageModel(0xA9, "openai_text-babbage-001", 1.3e9),
+        LanguageModel(0xAA, "openai_text-curie-001", 6.7e9),
+        LanguageModel(0xAB, "openai_text-davinci-002", 175e9),
+        LanguageModel(0xAC, "openai_text-davinci-003", 175e9),
+        LanguageModel(0xB0, "stanford_alpaca-7b", 7e9),
+        LanguageModel(0xC0, "tiiuae_falcon-40b", 40e9),
+        LanguageModel(0xC1, "tiiuae_falcon-40b-instruct", 40e9),
+        LanguageModel(0xC2, "tiiuae_falcon-7b", 7e9),
+        LanguageModel(0xC3, "tiiuae_falcon-7b-instruct", 7e9),
+        LanguageModel(0xD0, "together_bloom", 176e9),
+        LanguageModel(0xD1, "together_glm", 130e9),
+        LanguageModel(0xD2, "together_gpt-j-6b", 6e9),
+        LanguageModel(0xD3, "together_gpt-neox-20b", 20e9),
+        LanguageModel(0xD4, "together_opt-175b", 175e9),
+        LanguageModel(0xD5, "together_opt-66b", 66e9),
+        LanguageModel(0xD6, "together_redpajama-incite-base-3b-v1", 3e9),
+        LanguageModel(0xD7, "together_redpajama-incite-base-7b", 7e9),
+        LanguageModel(0xD8, "together_redpajama-incite-instruct-3b-v1", 3e9),
+        LanguageModel(0xD9, "together_redpajama-incite-instruct-7b", 7e9),
+        LanguageModel(0xDA, "together_t0pp", 11e9),
+        LanguageModel(0xDB, "together_t5-11b", 11e9),
+        LanguageModel(0xDC, "together_ul2", 20e9),
+        LanguageModel(0xDD, "together_yalm", 100e9),
+        LanguageModel(0xE0, "writer_palmyra-instruct-30", 30e9),
+        LanguageModel(0xE1, "writer_palmyra-x", 100e9),
+    };
+
+    /**
+     * @brief The vendor and size of the model with a given id; `evaluated` is false for unused ids.
+     */
+    struct ModelAttributes {
+        bool evaluated = false;
+        Vendor vendor = Vendor::AlephAlpha;
+        double parameters = 0;
+    };
+
+    /**
+     * @brief Model attributes indexed by model id, built at compile time from Models.
+     */
+    inline constexpr std::array<ModelAttributes, 256> ModelTable = [] {
+        std::array<ModelAttributes, 256> table {};
+        for (const LanguageModel& model : Models) {
+            table.at(model.id()) = { true, model.vendor(), model.parameters() };
+        }
+        return table;
+    }();
+
+    ModelSet modelsByVendor(const QList<int>& vendors);
+    ModelSet modelsBySize(double min, double max);
+} // namespace HPB
@@ -2,12 +2,20 @@
 
 #include <QApplication>
 #include <QScreen>
+#include <QSettings>
 #include <QStyle>
 #include <QSysInfo>
 
+#include "trace.hpp"
+
 int main(int argc, char *argv[])
 {
     QApplication const app(argc, argv);
+
+    // HPB_TRACE=<file>, or the TraceFile setting, writes a Chrome trace of the session to the file on exit
+    const QSettings settings(QSettings::IniFormat, QSettings::UserScope, "IIF-SADAF-CONICET", "HELMPromptBrowser");
+    const TraceSession trace(qEnvironmentVariable("HPB_TRACE", settings.value("TraceFile").toString()));
+
     if (QSysInfo::productType() != "macos") {
         QApplication::setStyle("fusion");
     }
@@ -2,36 +2,50 @@
 #include "./ui_mainwindow.h"
 
 #include <algorithm>
-#include <map>
 #include <ranges>
-#include <tuple>
 
+#include <QButtonGroup>
+#include <QComboBox>
 #include <QCompleter>
 #include <QDialog>
 #include <QFile>
 #include <QFileDialog>
+#include <QHash>
 #include <QInputDialog>
+#include <QItemSelectionModel>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLabel>
 #include <QLineEdit>
 #include <QList>
 #include <QMap>
 #include <QMessageBox>
 #include <QPair>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSet>
 #include <QSettings>
 #include <QShortcut>
+#include <QSpinBox>
 #include <QStandardPaths>
 #include <QString>
 #include <QStringList>
 #include <QStringListModel>
+#include <QThread>
 #include <QTreeWidgetItem>
 
+#include "commandlog.hpp"
+#include "compilationexport.hpp"
 #include "exportoptionsdialog.hpp"
+#include "helmdataconfig.hpp"
 #include "helperfunctions.hpp"
 #include "hpb_globals.hpp"
+#include "promptsearch.hpp"
 #include "queryparser.hpp"
+#include "trace.hpp"
 #include "vendordialog.hpp"
+#include "widgethelpers.hpp"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -44,7 +58,43 @@ MainWindow::MainWindow(QWidget *parent)
 
     ui->HELM_Data_lineEdit->setText(m_helmDataPath);
 
-    m_CIDCompleter = new QCompleter(m_CIDList, this);
+    ui->workerThreads_spinBox->setMaximum(QThread::idealThreadCount() * 4);
+    ui->workerThreads_spinBox->setValue(m_workerThreadCount);
+    ui->searchIndex_checkBox->setChecked(m_useFullTextIndex);
+    applyWorkerThreadCount();
+
+    /*******************
+     * Background jobs *
+     *******************/
+
+    m_searchJob = new SearchJob(&m_searchPool, this);
+    m_filterJob = new FilterJob(&m_searchPool, this);
+    m_exportJob = new ExportJob(&m_searchPool, this);
+
+    m_progressLabel = new QLabel(this);
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 1000);
+    m_progressBar->setTextVisible(false);
+    m_cancelJobButton = new QPushButton("Cancel", this);
+    ui->statusbar->addPermanentWidget(m_progressLabel);
+    ui->statusbar->addPermanentWidget(m_progressBar);
+    ui->statusbar->addPermanentWidget(m_cancelJobButton);
+    m_progressLabel->hide();
+    m_progressBar->hide();
+    m_cancelJobButton->hide();
+
+    connect(m_cancelJobButton, &QPushButton::clicked, this, [this]() {
+        if (m_activeJob != nullptr) {
+            m_activeJob->cancel();
+        }
+    });
+    connect(m_searchJob, &SearchJob::datasetsReady, this, &MainWindow::addDatasetMatches);
+    for (BackgroundJob* job : std::initializer_list<BackgroundJob*>{ m_searchJob, m_filterJob, m_exportJob }) {
+        connect(job, &BackgroundJob::progressChanged, this, &MainWindow::updateJobProgress);
+        connect(job, &BackgroundJob::finished, this, &MainWindow::jobFinished);
+    }
+
+    m_CIDCompleter = new QCompleter(QStringList(), this);
     m_CIDCompleter->setCaseSensitivity(Qt::CaseInsensitive);
     ui->filterPromptsByCID_lineEdit->setCompleter(m_CIDCompleter);
 
@@ -52,365 +102,69 @@ MainWindow::MainWindow(QWidget *parent)
      * Set up dataset tree *
      ***********************/
 
-    const std::map<QString, QList<std::tuple<QString, int, QList<int>>>> HELMDatasetHierarchy = {
-        {
-            "babi_qa", QList({
-                std::make_tuple(QString("babi_qa:task=15"), 70, HPB::list_70),
-                std::make_tuple(QString("babi_qa:task=19"), 70, HPB::list_70),
-                std::make_tuple(QString("babi_qa:task=3"), 70, HPB::list_70),
-                std::make_tuple(QString("babi_qa:task=all"), 70, HPB::list_70),
-            })
-        },
-        {
-            "bbq", QList({
-                std::make_tuple(QString("bbq:subject=all,method=multiple_choice_joint"), 42, HPB::list_42),
-                std::make_tuple(QString("bbq:subject=all,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("bbq:subject=all,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "blimp", QList({
-                std::make_tuple(QString("blimp:phenomenon=binding,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=binding,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=binding,method=multiple_choice_separate_original"), 32, HPB::list_32),
-                std::make_tuple(QString("blimp:phenomenon=irregular_forms,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=irregular_forms,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=irregular_forms,method=multiple_choice_separate_original"), 32, HPB::list_32),
-                std::make_tuple(QString("blimp:phenomenon=island_effects,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=island_effects,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=island_effects,method=multiple_choice_separate_original"), 32, HPB::list_32),
-                std::make_tuple(QString("blimp:phenomenon=quantifiers,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=quantifiers,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("blimp:phenomenon=quantifiers,method=multiple_choice_separate_original"), 32, HPB::list_32),
-            })
-        },
-        {
-            "bold:subject=all", QList({
-                std::make_tuple(QString(""), 42, HPB::list_42)
-            })
-        },
-        {
-            "boolq", QList({
-                std::make_tuple(QString(""), 67, HPB::list_67)
-            })
-        },
-        {
-            "boolq:only_contrast=True", QList({
-                std::make_tuple(QString(""), 42, HPB::list_42)
-            })
-        },
-        {
-            "civil_comments", QList({
-                std::make_tuple(QString("civil_comments:demographic=LGBTQ"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=all"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=black"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=christian"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=female"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=male"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=muslim"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=other_religions"), 67, HPB::list_67),
-                std::make_tuple(QString("civil_comments:demographic=white"), 67, HPB::list_67),
-            })
-        },
-        {
-            "code", QList({
-                std::make_tuple(QString("code:dataset=apps"), 2, HPB::list_2),
-                std::make_tuple(QString("code:dataset=humaneval"), 2, HPB::list_2)
-            })
-        },
-        {
-            "commonsense", QList({
-                std::make_tuple(QString("commonsense:dataset=hellaswag,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("commonsense:dataset=hellaswag,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("commonsense:dataset=hellaswag,method=multiple_choice_separate_original"), 32, HPB::list_32),
-                std::make_tuple(QString("commonsense:dataset=openbookqa,method=multiple_choice_joint"), 6, HPB::list_6),
-                std::make_tuple(QString("commonsense:dataset=openbookqa,method=multiple_choice_separate_calibrated"), 32, HPB::list_32),
-                std::make_tuple(QString("commonsense:dataset=openbookqa,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "copyright", QList({
-                std::make_tuple(QString("copyright:datatag=n_books_1000-extractions_per_book_1-prefix_length_125"), 42, HPB::list_42),
-                std::make_tuple(QString("copyright:datatag=oh_the_places"), 10, HPB::list_10),
-                std::make_tuple(QString("copyright:datatag=popular_books-prefix_length_125.json"), 42, HPB::list_42),
-                std::make_tuple(QString("copyright:datatag=prompt_num_line_1-min_lines_20.json"), 2, HPB::list_2),
-                std::make_tuple(QString("copyright:datatag=prompt_num_line_10-min_lines_20.json"), 2, HPB::list_2),
-            })
-        },
-        {
-            "disinfo", QList({
-                std::make_tuple(QString("disinfo:type=reiteration,topic=climate"), 42, HPB::list_42),
-                std::make_tuple(QString("disinfo:type=reiteration,topic=covid"), 42, HPB::list_42),
-                std::make_tuple(QString("disinfo:type=wedging"), 42, HPB::list_42),
-            })
-        },
-        {
-            "dyck_language_np=3", QList({
-                std::make_tuple(QString(""), 69, HPB::list_69)
-            })
-        },
-        {
-            "entity_data_imputation", QList({
-                std::make_tuple(QString("entity_data_imputation:dataset=Buy"), 69, HPB::list_69),
-                std::make_tuple(QString("entity_data_imputation:dataset=Restaurant"), 69, HPB::list_69),
-            })
-        },
-        {
-            "entity_matching", QList({
-                std::make_tuple(QString("entity_matching:dataset=Abt_Buy"), 69, HPB::list_69),
-                std::make_tuple(QString("entity_matching:dataset=Beer"), 69, HPB::list_69),
-                std::make_tuple(QString("entity_matching:dataset=Dirty_iTunes_Amazon"), 69, HPB::list_69),
-            })
-        },
-        {
-            "gsm", QList({
-                std::make_tuple(QString(""), 69, HPB::list_69)
-            })
-        },
-        {
-            "ice", QList({
-                std::make_tuple(QString("ice:gender=female"), 32, HPB::list_32),
-                std::make_tuple(QString("ice:gender=male"), 32, HPB::list_32),
-                std::make_tuple(QString("ice:subset=ea"), 32, HPB::list_32),
-                std::make_tuple(QString("ice:subset=hk"), 32, HPB::list_32),
-                std::make_tuple(QString("ice:subset=ind"), 32, HPB::list_32),
-                std::make_tuple(QString("ice:subset=usa"), 32, HPB::list_32),
-            })
-        },
-        {
-            "imdb", QList({
-                std::make_tuple(QString(""), 67, HPB::list_67)
-            })
-        },
-        {
-            "imdb:only_contrast=True", QList({
-                std::make_tuple(QString(""),42, HPB::list_42)
-            })
-        },
-        {
-            "legal_support", QList({
-                std::make_tuple(QString("legal_support,method=multiple_choice_joint"), 69, HPB::list_69),
-                std::make_tuple(QString("legal_support,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("legal_support,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "lsat_qa", QList({
-                std::make_tuple(QString("lsat_qa:task=all,method=multiple_choice_joint"), 69, HPB::list_69),
-                std::make_tuple(QString("lsat_qa:task=all,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("lsat_qa:task=all,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "math", QList({
-                std::make_tuple(QString("math:subject=algebra,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=algebra,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=counting_and_probability,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=counting_and_probability,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=geometry,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=geometry,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=intermediate_algebra,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=intermediate_algebra,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=number_theory,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=number_theory,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=prealgebra,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=prealgebra,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=precalculus,level=1,use_official_examples=False,use_chain_of_thought=True"), 69, HPB::list_69),
-                std::make_tuple(QString("math:subject=precalculus,level=1,use_official_examples=True,use_chain_of_thought=False"), 69, HPB::list_69),
-            })
-        },
-        {
-            "mmlu", QList({
-                std::make_tuple(QString("mmlu:subject=abstract_algebra,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("mmlu:subject=abstract_algebra,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=abstract_algebra,method=multiple_choice_separate_original"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=college_chemistry,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("mmlu:subject=college_chemistry,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=college_chemistry,method=multiple_choice_separate_original"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=computer_security,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("mmlu:subject=computer_security,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=computer_security,method=multiple_choice_separate_original"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=econometrics,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("mmlu:subject=econometrics,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=econometrics,method=multiple_choice_separate_original"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=us_foreign_policy,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("mmlu:subject=us_foreign_policy,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("mmlu:subject=us_foreign_policy,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "msmarco", QList({
-                std::make_tuple(QString("msmarco:track=regular,valid_topk=30"), 32, HPB::list_32),
-                std::make_tuple(QString("msmarco:track=trec,valid_topk=30"), 32, HPB::list_32),
-            })
-        },
-        {
-            "narrative_qa", QList({
-                std::make_tuple(QString(""), 66, HPB::list_66b)
-            })
-        },
-        {
-            "natural_qa", QList({
-                std::make_tuple(QString("natural_qa:mode=closedbook"), 67, HPB::list_67),
-                std::make_tuple(QString("natural_qa:mode=openbook_longans"), 66, HPB::list_66a),
-            })
-        },
-        {
-            "quac", QList({
-                std::make_tuple(QString(""), 66, HPB::list_66b)
-            })
-        },
-        {
-            "raft", QList({
-                std::make_tuple(QString("raft:subset=ade_corpus_v2"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=banking_77"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=neurips_impact_statement_risks"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=one_stop_english"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=overruling"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=semiconductor_org_types"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=systematic_review_inclusion"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=tai_safety_research"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=terms_of_service"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=tweet_eval_hate"), 67, HPB::list_67),
-                std::make_tuple(QString("raft:subset=twitter_complaints"), 67, HPB::list_67),
-            })
-        },
-        {
-            "real_toxicity_prompts", QList({
-                std::make_tuple(QString(""), 42, HPB::list_42)
-            })
-        },
-        {
-            "summarization_cnndm", QList({
-                std::make_tuple(QString("summarization_cnndm:temperature=0.3,device=cpu"), 42, HPB::list_42),
-                std::make_tuple(QString("summarization_cnndm:temperature=0.3,device=cuda"), 40, HPB::list_40),
-            })
-        },
-        {
-            "summarization_xsum", QList({
-                std::make_tuple(QString("summarization_xsum:temperature=0.3,device=cpu"), 42, HPB::list_42),
-                std::make_tuple(QString("summarization_xsum:temperature=0.3,device=cuda"), 40, HPB::list_40),
-            })
-        },
-        {
-            "synthetic_efficiency:random=None", QList({
-             std::make_tuple(QString(""), 39, HPB::list_39)
-            })
-        },
-        {
-            "synthetic_reasoning", QList({
-                std::make_tuple(QString("synthetic_reasoning:mode=induction"), 69, HPB::list_69),
-                std::make_tuple(QString("synthetic_reasoning:mode=pattern_match"), 69, HPB::list_69),
-                std::make_tuple(QString("synthetic_reasoning:mode=variable_substitution"), 69, HPB::list_69),
-            })
-        },
-        {
-            "synthetic_reasoning_natural", QList({
-                std::make_tuple(QString("synthetic_reasoning_natural:difficulty=easy"), 69, HPB::list_69),
-                std::make_tuple(QString("synthetic_reasoning_natural:difficulty=hard"), 69, HPB::list_69),
-            })
-        },
-        {
-            "the_pile", QList({
-                std::make_tuple(QString("the_pile:subset=ArXiv"), 24, HPB::list_24),
-                std::make_tuple(QString("the_pile:subset=BookCorpus2"), 32, HPB::list_32),
-                std::make_tuple(QString("the_pile:subset=Enron Emails"), 32, HPB::list_32),
-                std::make_tuple(QString("the_pile:subset=Github"), 24, HPB::list_24),
-                std::make_tuple(QString("the_pile:subset=PubMed Central"), 24, HPB::list_24),
-                std::make_tuple(QString("the_pile:subset=Wikipedia (en)"), 32, HPB::list_32),
-            })
-        },
-        {
-            "truthful_qa", QList({
-                std::make_tuple(QString("truthful_qa:task=mc_single,method=multiple_choice_joint"), 67, HPB::list_67),
-                std::make_tuple(QString("truthful_qa:task=mc_single,method=multiple_choice_separate_calibrated"), 6, HPB::list_6),
-                std::make_tuple(QString("truthful_qa:task=mc_single,method=multiple_choice_separate_original"), 6, HPB::list_6),
-            })
-        },
-        {
-            "twitter_aae", QList({
-                std::make_tuple(QString("twitter_aae:demographic=aa"), 32, HPB::list_32),
-                std::make_tuple(QString("twitter_aae:demographic=white"), 32, HPB::list_32),
-            })
-        },
-        {
-            "wikifact", QList({
-                std::make_tuple(QString("wikifact:k=5,subject=author"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=currency"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=discoverer_or_inventor"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=instance_of"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=medical_condition_treated"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=part_of"), 66, HPB::list_66b),
-                std::make_tuple(QString("wikifact:k=5,subject=place_of_birth"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=plaintiff"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=position_held"), 67, HPB::list_67),
-                std::make_tuple(QString("wikifact:k=5,subject=symptoms_and_signs"), 67, HPB::list_67),
-            })
-        }
-    };
-
     ui->dataset_treeWidget->setColumnCount(HPB::DTColumnCount);
 
     for (int i : _range(HPB::DTNumberOfModels, HPB::DTColumnCount)) {
         ui->dataset_treeWidget->hideColumn(i);
     }
 
-    for (const auto& [task, vector] : HELMDatasetHierarchy) {
-        auto *item = new QTreeWidgetItem();
-        item->setCheckState(HPB::DTDatasetNameColumn, Qt::Unchecked);
-        item->setFlags(item->flags() | Qt::ItemIsAutoTristate);
-        item->setData(HPB::DTDatasetNameColumn, Qt::DisplayRole, task);
-        for (const auto& [subTask, numberOfModels, modelList]  : vector) {
-            if (subTask.isEmpty()) {
-                item->setData(HPB::DTNumberOfModels, Qt::DisplayRole, numberOfModels);
-                item->setData(HPB::DTLMListColumn, Qt::DisplayRole, QVariant::fromValue<QList<int>>(modelList));
-                continue;
-            }
-            auto *child = new QTreeWidgetItem();
-            child->setCheckState(HPB::DTDatasetNameColumn, Qt::Unchecked);
-            child->setData(HPB::DTDatasetNameColumn, Qt::DisplayRole, subTask);
-            child->setData(HPB::DTNumberOfModels, Qt::DisplayRole, numberOfModels);
-            child->setData(HPB::DTLMListColumn, Qt::DisplayRole, QVariant::fromValue<QList<int>>(modelList));
-            item->addChild(child);
+    // an empty CachePath keeps the manifest in memory only
+    m_datasetManifest.setManifestFile(m_cachePath.isEmpty() ? QString() : QDir(m_cachePath).filePath("datasets.hpbm"));
+    populateDatasetTree();
+
+    // the dataset filters are cheap enough to be applied as the controls change
+    connect(ui->filterByNumber_modelNumber_spinBox, &QSpinBox::valueChanged, this, &MainWindow::applyDatasetFilters);
+    connect(ui->filterBySize_buttonGroup, &QButtonGroup::idToggled, this, [this](int, bool checked) {
+        if (checked) {
+            applyDatasetFilters();
         }
-        ui->dataset_treeWidget->addTopLevelItem(item);
-    }
+    });
+    connect(ui->filterBySize_CustomInterval_min_comboBox, &QComboBox::currentIndexChanged, this, &MainWindow::applyDatasetFilters);
+    connect(ui->filterBySize_CustomInterval_max_comboBox, &QComboBox::currentIndexChanged, this, &MainWindow::applyDatasetFilters);
 
     /**********************
      * Set up prompt tree *
      **********************/
 
-    ui->prompts_treeWidget->setColumnCount(HPB::PTColumnCount);
-    ui->prompts_treeWidget->setHeaderLabels({"Custom Dataset ID", "Dataset name / Prompt ID"});
-    for (int i : _range(HPB::PTDatasetBaseColumn, HPB::PTColumnCount)) {
-        ui->prompts_treeWidget->hideColumn(i);
-    }
-    ui->prompts_treeWidget->setColumnWidth(HPB::PTCIDColumn, 120);
-    ui->prompts_treeWidget->header()->setStretchLastSection(true);
-    ui->prompts_treeWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_promptModel = new PromptTreeModel(this);
+    ui->prompts_treeView->setModel(m_promptModel);
+    ui->prompts_treeView->setColumnWidth(HPB::PTCIDColumn, 120);
+    ui->prompts_treeView->header()->setStretchLastSection(true);
+    ui->prompts_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    connect(ui->prompts_treeView->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::showCurrentPrompt);
+    connect(m_promptModel, &PromptTreeModel::cidsChanged, this, &MainWindow::updateCidCounts);
+
+    m_commandLog = new CommandLog(m_promptModel, this);
+    m_commandLog->setMemoryLimit(qsizetype(m_undoMemoryLimitMB) * 1024 * 1024);
+    connect(m_commandLog, &CommandLog::changed, this, [this]() {
+        ui->undo_pushButton->setEnabled(m_commandLog->canUndo());
+        ui->redo_pushButton->setEnabled(m_commandLog->canRedo());
+    });
+
+    ui->cidCounts_treeWidget->setColumnWidth(0, 200);
 
     /*********************
      * Editing shortcuts *
      *********************/
 
-    auto *deleteShortcut1 = new QShortcut(QKeySequence(Qt::Key_Delete), ui->prompts_treeWidget);
+    auto *deleteShortcut1 = new QShortcut(QKeySequence(Qt::Key_Delete), ui->prompts_treeView);
     connect(deleteShortcut1, SIGNAL(activated()), this, SLOT(on_delete_pushButton_clicked()));
-    auto *undoShortcut1 = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Z), ui->prompts_treeWidget);
+    auto *undoShortcut1 = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Z), ui->prompts_treeView);
     connect(undoShortcut1, SIGNAL(activated()), this, SLOT(on_undo_pushButton_clicked()));
-    auto *redoShortcut1 = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Y), ui->prompts_treeWidget);
+    auto *redoShortcut1 = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Y), ui->prompts_treeView);
     connect(redoShortcut1, SIGNAL(activated()), this, SLOT(on_redo_pushButton_clicked()));
-    auto *redoShortcut2 = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Z), ui->prompts_treeWidget);
+    auto *redoShortcut2 = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Z), ui->prompts_treeView);
     connect(redoShortcut2, SIGNAL(activated()), this, SLOT(on_redo_pushButton_clicked()));
-    auto *clearShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_X), ui->prompts_treeWidget);
+    auto *clearShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_X), ui->prompts_treeView);
     connect(clearShortcut, SIGNAL(activated()), this, SLOT(on_clear_pushButton_clicked()));
 
-    auto *selectShortcut = new QShortcut(QKeySequence(Qt::Key_S), ui->prompts_treeWidget);
+    auto *selectShortcut = new QShortcut(QKeySequence(Qt::Key_S), ui->prompts_treeView);
     connect(selectShortcut, SIGNAL(activated()), this, SLOT(on_selectPrompt_pushButton_clicked()));
-    auto *deselectShortcut = new QShortcut(QKeySequence(Qt::Key_D), ui->prompts_treeWidget);
+    auto *deselectShortcut = new QShortcut(QKeySequence(Qt::Key_D), ui->prompts_treeView);
     connect(deselectShortcut, SIGNAL(activated()), this, SLOT(on_deselectPrompt_pushButton_clicked()));
-    auto *assignCIDShortcut = new QShortcut(QKeySequence(Qt::Key_A), ui->prompts_treeWidget);
+    auto *assignCIDShortcut = new QShortcut(QKeySequence(Qt::Key_A), ui->prompts_treeView);
     connect(assignCIDShortcut, SIGNAL(activated()), this, SLOT(on_assignCID_pushButton_clicked()));
-    auto *clearCIDShortcut = new QShortcut(QKeySequence(Qt::Key_C), ui->prompts_treeWidget);
+    auto *clearCIDShortcut = new QShortcut(QKeySequence(Qt::Key_C), ui->prompts_treeView);
     connect(clearCIDShortcut, SIGNAL(activated()), this, SLOT(on_clearCID_pushButton_clicked()));
 }
 
@@ -424,6 +178,7 @@ void MainWindow::on_HELM_Data_pushButton_clicked()
     const QString path = QFileDialog::getExistingDirectory(this, "Select HELM data folder", QStandardPaths::displayName(QStandardPaths::DocumentsLocation));
     m_helmDataPath = path.isEmpty() ? m_helmDataPath : path;
     ui->HELM_Data_lineEdit->setText(m_helmDataPath);
+    populateDatasetTree();
 }
 
 /*******************************************
@@ -442,7 +197,26 @@ void MainWindow::on_deselect_all_pushButton_clicked()
 }
 
 namespace {
-    QPair<QMap<QString, QStringList>, QList<std::tuple<QString, QString, QMap<QString, QString>>>> extractDataFromJSON(QFile& jsonFile)
+    /**
+     * @brief The datasets and samples of a compilation file.
+     */
+    struct CompilationSelection {
+        QSet<QString> datasets;
+        QHash<QString, QHash<QString, QString>> samples;    // dataset name -> prompt id -> CID
+    };
+
+    /**
+     * @brief Builds the name under which a (sub)dataset is listed in the dataset tree.
+     */
+    QString datasetName(const QString& datasetBase, const QString& datasetSpec)
+    {
+        if (datasetSpec.isEmpty()) {
+            return datasetBase;
+        }
+        return datasetBase + (datasetBase == "legal_support" ? "," : ":") + datasetSpec;
+    }
+
+    CompilationSelection extractDataFromJSON(QFile& jsonFile)
     {
         const QJsonDocument customCompilation = QJsonDocument::fromJson(jsonFile.readAll());
 
@@ -468,63 +242,51 @@ namespace {
 
         const QJsonArray datasetArray = customCompilation["datasets"].toArray();
 
-        QMap<QString, QStringList> selectedDatasets;
-        QList<std::tuple<QString, QString, QMap<QString, QString>>> selectedPrompts;
-
+        CompilationSelection selection;
         for (auto&& value : datasetArray) {
             const QJsonObject dataset = value.toObject();
-            const QString datasetName = dataset.keys().at(0);
-            const QString datasetSpec = dataset[datasetName]["dataset_spec"].toString();
-
-            if (!selectedDatasets.contains(datasetName)) {
-                selectedDatasets[datasetName] = {};
-            }
-            if (datasetSpec.isEmpty()) {
-                continue;
-            }
-            if (datasetName == "legal_support") {
-                selectedDatasets[datasetName].push_back(datasetName + "," + datasetSpec);
-            }
-            else {
-                selectedDatasets[datasetName].push_back(datasetName + ":" + datasetSpec);
+            const QString datasetBase = dataset.keys().at(0);
+            const QJsonObject datasetSpecification = dataset[datasetBase].toObject();
+            const QString name = datasetName(datasetBase, datasetSpecification["dataset_spec"].toString());
+            selection.datasets.insert(name);
+
+            const QJsonObject samples = datasetSpecification["samples"].toObject();
+            QHash<QString, QString>& cids = selection.samples[name];
+            cids.reserve(cids.size() + samples.size());
+            for (auto sample = samples.constBegin(); sample != samples.constEnd(); ++sample) {
+                cids.insert(sample.key(), sample.value().toString());
             }
-
-            const QJsonObject samples = dataset[datasetName]["samples"].toObject();
-            QMap<QString, QString> selected;
-            std::ranges::for_each(samples.keys(), [&](const QString& promptId) { selected[promptId] = samples[promptId].toString(); });
-            selectedPrompts.push_back({ datasetName, datasetSpec, selected });
         }
 
-        return { selectedDatasets, selectedPrompts };
+        return selection;
     }
 
-    void restoreDatasetSelection(const QMap<QString, QStringList>& selectedDatasets, QTreeWidget* datasetTree)
+    /**
+     * @brief Checks exactly the given datasets in the dataset tree.
+     *
+     * @return QStringList The datasets that are not in the tree.
+     */
+    QStringList restoreDatasetSelection(const QSet<QString>& datasets, QTreeWidget* datasetTree)
     {
-        const auto uncheckDataset = [&](QTreeWidgetItem* dataset) -> void { dataset->setCheckState(HPB::DTDatasetNameColumn, Qt::Unchecked); };
-        transformDatasetTree(datasetTree, uncheckDataset);
-
-        for (const auto& [datasetName, subDatasets] : selectedDatasets.asKeyValueRange()) {
-            QTreeWidgetItem* dataset = datasetTree->findItems(datasetName, Qt::MatchExactly, HPB::DTDatasetNameColumn).at(0);
-
-            if (subDatasets.isEmpty()) {
-                dataset->setCheckState(0, Qt::Checked);
-                continue;
-            }
-
-            const int childCount = dataset->childCount();
-            for (int i : _range(0, childCount)) {
-                QTreeWidgetItem* child = dataset->child(i);
-                const QString childName = child->data(HPB::DTDatasetNameColumn, Qt::DisplayRole).toString();
-                if (subDatasets.contains(childName)) {
-                    child->setCheckState(HPB::DTDatasetNameColumn, Qt::Checked);
-                }
-            }
-        }
+        QSet<QString> missing = datasets;
+        const auto checkDataset = [&](QTreeWidgetItem* dataset) -> void {
+            const bool selected = missing.remove(dataset->data(HPB::DTDatasetNameColumn, Qt::DisplayRole).toString());
+            dataset->setCheckState(HPB::DTDatasetNameColumn, selected ? Qt::Checked : Qt::Unchecked);
+        };
+        transformDatasetTree(datasetTree, checkDataset);
+
+        QStringList missingDatasets = missing.values();
+        missingDatasets.sort();
+        return missingDatasets;
     }
 }
 
 void MainWindow::on_loadFromFile_pushButton_clicked()
 {
+    if (m_activeJob != nullptr) {
+        return;
+    }
+
     /********************************
      * 1. Open JSON file for import *
      ********************************/
@@ -541,6 +303,9 @@ void MainWindow::on_loadFromFile_pushButton_clicked()
         return;
     }
 
+    // the spans of the entry points start after their dialogs, so that they do not time the user
+    const TraceSpan span("on_loadFromFile_pushButton_clicked", fromFile);
+
     const qsizetype pos = fromFile.lastIndexOf("/");
     m_importFileFolder = fromFile.sliced(0, pos);
 
@@ -556,34 +321,36 @@ void MainWindow::on_loadFromFile_pushButton_clicked()
      * 2. Extract selection and CID data from JSON *
      ***********************************************/
 
-    const auto [selectedDatasets, selectedPrompts] = extractDataFromJSON(jsonFile);
+    CompilationSelection selection = extractDataFromJSON(jsonFile);
 
 
     /***************************************
      * 3. Restore dataset selection status *
      ***************************************/
 
-    restoreDatasetSelection(selectedDatasets, ui->dataset_treeWidget);
+    const QStringList missingDatasets = restoreDatasetSelection(selection.datasets, ui->dataset_treeWidget);
+    if (!missingDatasets.isEmpty()) {
+        Warn("The following datasets of the compilation are not under the HELM data path and will be skipped:\n\n" + missingDatasets.join("\n"));
+    }
 
 
     /*********************************
      * 4. Add prompts to prompt tree *
      *********************************/
 
-    const QStringList datasetsToBeAdded = getSelectedDatasetNames(ui->dataset_treeWidget);
-    const QStringList taskDirs = getHelmTaskDirs(datasetsToBeAdded, m_helmDataPath);
+    QStringList datasetsToBeAdded = getSelectedDatasetNames(ui->dataset_treeWidget);
+    const QStringList taskDirs = resolveTaskDirs(datasetsToBeAdded);
     Q_ASSERT_X(taskDirs.size() == datasetsToBeAdded.size(), "Taks directories and selected datasets have different cardinalities", "mainwindow.cpp");
-    const qsizetype taskDirsCount = taskDirs.count();
 
-    for (qsizetype j : _range(0, taskDirsCount)) {
-        const QString& dataset = datasetsToBeAdded.at(j);
-
-        const QJsonDocument instances = getTaskInstances(taskDirs.at(j), m_helmDataPath);
-        if (instances.isEmpty()) {
-            return;
+    // only the instances listed in the compilation are loaded
+    QHash<QString, QSet<QString>> idsByDataset;
+    idsByDataset.reserve(selection.samples.size());
+    for (const auto [name, cids] : selection.samples.asKeyValueRange()) {
+        QSet<QString>& ids = idsByDataset[name];
+        ids.reserve(cids.size());
+        for (auto sample = cids.cbegin(); sample != cids.cend(); ++sample) {
+            ids.insert(sample.key());
         }
-
-        addPromptsToTree(dataset, instances, {{},{}}, false, false, ui->prompts_treeWidget);
     }
 
 
@@ -591,183 +358,205 @@ void MainWindow::on_loadFromFile_pushButton_clicked()
      * 5. Restore prompt selection status and store CIDs for completer *
      *******************************************************************/
 
-    // has a side-effect on m_CIDList
-    const auto restorePromptTreeData = [&](QTreeWidgetItem* item) -> void {
-        if (item == nullptr) {
-            return;
-        }
-        if (!isPrompt(item)) {
-            return;
-        }
-
-        const QString datasetBase = getDatasetBase(item);
-        const QString datasetSpec = getDatasetSpec(item);
-        const QString promptId = getName(item);
-        QString promptCId;
-
-        for (const auto& [db, ds, idCIdMap] : selectedPrompts) {
-            if (db != datasetBase || ds != datasetSpec) {
+    // runs once the prompts are in the tree
+    const PromptStore& store = m_promptModel->store();
+    const auto restorePromptData = [this, samples = std::move(selection.samples),
+                                    baseCount = store.baseCount(), groupCount = store.groupCount(), promptCount = store.promptCount()](bool /* cancelled */) -> void {
+        const TraceSpan span("restorePromptData");
+        const PromptStore& store = m_promptModel->store();
+
+        // prompts are collected per CID, so that the CID index and panel are updated once per CID
+        QHash<QString, QList<PromptStore::PromptId>> promptsByCid;
+        QList<PromptStore::PromptId> selected;
+
+        // attached prompts come grouped by (sub)dataset, so its samples are looked up once per group
+        PromptStore::GroupId group = -1;
+        const QHash<QString, QString>* groupSamples = nullptr;
+        for (const PromptStore::PromptId prompt : store.attachedPrompts()) {
+            if (store.promptGroup(prompt) != group) {
+                group = store.promptGroup(prompt);
+                const auto it = samples.constFind(datasetName(store.baseName(store.groupBase(group)), store.groupSpec(group)));
+                groupSamples = it != samples.cend() ? &it.value() : nullptr;
+            }
+            if (groupSamples == nullptr) {
                 continue;
             }
 
-            if (!idCIdMap.contains(promptId)) {
-                return;
+            const auto cid = groupSamples->constFind(store.promptId(prompt).toString());
+            if (cid != groupSamples->cend()) {
+                promptsByCid[cid.value()].push_back(prompt);
+                selected.push_back(prompt);
             }
+        }
 
-            promptCId = idCIdMap[promptId];
-            setCID(item, promptCId);
-            setSelectedStatus(item, true);
-
-            if (!m_CIDList.contains(promptCId)) {
-                m_CIDList.push_back(promptCId);
-            }
+        // the added prompts and their CIDs and selection are undone as one import
+        m_commandLog->beginCommand();
+        m_commandLog->recordAddedSince(baseCount, groupCount, promptCount);
+        for (auto [cid, prompts] : promptsByCid.asKeyValueRange()) {
+            m_commandLog->setCid(prompts, cid);
+        }
+        m_commandLog->setSelected(selected, true);
+        m_commandLog->endCommand();
+
+        /*************************
+         * 6. Manage GUI changes *
+         *************************/
+
+        if (m_promptModel->rowCount() > 0) {
+            ui->delete_pushButton->setEnabled(true);
+            ui->clear_pushButton->setEnabled(true);
+            ui->selectPrompt_pushButton->setEnabled(true);
+            ui->deselectPrompt_pushButton->setEnabled(true);
+            ui->assignCID_pushButton->setEnabled(true);
+            ui->clearCID_pushButton->setEnabled(true);
         }
     };
 
-    m_CIDList.clear();
-    transformPromptTree(ui->prompts_treeWidget, restorePromptTreeData);
-    auto* model = dynamic_cast<QStringListModel*>(m_CIDCompleter->model());
-    model->setStringList(m_CIDList);
-
-    /*************************
-     * 6. Manage GUI changes *
-     *************************/
-
-    if (ui->prompts_treeWidget->topLevelItemCount() > 0) {
-        ui->delete_pushButton->setEnabled(true);
-        ui->clear_pushButton->setEnabled(true);
-        ui->selectPrompt_pushButton->setEnabled(true);
-        ui->deselectPrompt_pushButton->setEnabled(true);
-        ui->assignCID_pushButton->setEnabled(true);
-        ui->clearCID_pushButton->setEnabled(true);
+    if (datasetsToBeAdded.isEmpty()) {
+        restorePromptData(false);
+        return;
     }
+
+    connect(m_searchJob, &SearchJob::finished, this, restorePromptData, Qt::SingleShotConnection);
+    startJob(m_searchJob, "Importing");
+    m_searchJob->start(datasetsToBeAdded, taskDirs, m_helmDataPath, m_cachePath, CompiledQuery(getQueryExpression(QString()), false, false), false, idsByDataset);
 }
 
 void MainWindow::on_filterByNumber_checkBox_checkStateChanged(const Qt::CheckState &arg1)
 {
-    if (arg1 == Qt::Checked) {
-        ui->filterByNumber_modelNumber_spinBox->setEnabled(true);
-        ui->filterByNumber_label1->setEnabled(true);
-        ui->filterByNumber_label2->setEnabled(true);
-        ui->applyDatasetFilters_pushButton->setEnabled(true);
-        ui->clearDatasetFilters_pushButton->setEnabled(true);
-    }
-    else {
-        ui->filterByNumber_modelNumber_spinBox->setEnabled(false);
-        ui->filterByNumber_label1->setEnabled(false);
-        ui->filterByNumber_label2->setEnabled(false);
-
-        if (ui->filterBySize_checkBox->checkState() == Qt::Unchecked && ui->filterByVendor_checkBox->checkState() == Qt::Unchecked) {
-            ui->applyDatasetFilters_pushButton->setEnabled(false);
-            ui->clearDatasetFilters_pushButton->setEnabled(false);
-            on_clearDatasetFilters_pushButton_clicked();
-        }
-    }
+    const bool checked = arg1 == Qt::Checked;
+    ui->filterByNumber_modelNumber_spinBox->setEnabled(checked);
+    ui->filterByNumber_label1->setEnabled(checked);
+    ui->filterByNumber_label2->setEnabled(checked);
+
+    applyDatasetFilters();
 }
 void MainWindow::on_filterBySize_checkBox_checkStateChanged(const Qt::CheckState &arg1)
 {
-    if (arg1 == Qt::Checked) {
-        ui->filterBySize_ReallyTiny_radioButton->setEnabled(true);
-        ui->filterBySize_Tiny_radioButton->setEnabled(true);
-        ui->filterBySize_Small_radioButton->setEnabled(true);
-        ui->filterBySize_Medium_radioButton->setEnabled(true);
-        ui->filterBySize_Large_radioButton->setEnabled(true);
-        ui->filterBySize_CustomInterval_radioButton->setEnabled(true);
-        ui->applyDatasetFilters_pushButton->setEnabled(true);
-        ui->clearDatasetFilters_pushButton->setEnabled(true);
-        if (ui->filterBySize_CustomInterval_radioButton->isChecked()) {
-            ui->filterBySize_CustomInterval_min_comboBox->setEnabled(true);
-            ui->filterBySize_CustomInterval_max_comboBox->setEnabled(true);
-            ui->filterBySize_CustomInterval_label1->setEnabled(true);
-            ui->filterBySize_CustomInterval_label2->setEnabled(true);
-            ui->filterBySize_CustomInterval_label3->setEnabled(true);
-            ui->filterBySize_CustomInterval_label4->setEnabled(true);
-        }
-    }
-    else {
-        ui->filterBySize_ReallyTiny_radioButton->setEnabled(false);
-        ui->filterBySize_Tiny_radioButton->setEnabled(false);
-        ui->filterBySize_Small_radioButton->setEnabled(false);
-        ui->filterBySize_Medium_radioButton->setEnabled(false);
-        ui->filterBySize_Large_radioButton->setEnabled(false);
-        ui->filterBySize_CustomInterval_radioButton->setEnabled(false);
-        if (ui->filterByNumber_checkBox->checkState() == Qt::Unchecked && ui->filterByVendor_checkBox->checkState() == Qt::Unchecked) {
-            ui->applyDatasetFilters_pushButton->setEnabled(false);
-            ui->clearDatasetFilters_pushButton->setEnabled(false);
-            on_clearDatasetFilters_pushButton_clicked();
-        }
-        ui->filterBySize_CustomInterval_min_comboBox->setEnabled(false);
-        ui->filterBySize_CustomInterval_max_comboBox->setEnabled(false);
-        ui->filterBySize_CustomInterval_label1->setEnabled(false);
-        ui->filterBySize_CustomInterval_label2->setEnabled(false);
-        ui->filterBySize_CustomInterval_label3->setEnabled(false);
-        ui->filterBySize_CustomInterval_label4->setEnabled(false);
-    }
+    const bool checked = arg1 == Qt::Checked;
+    ui->filterBySize_ReallyTiny_radioButton->setEnabled(checked);
+    ui->filterBySize_Tiny_radioButton->setEnabled(checked);
+    ui->filterBySize_Small_radioButton->setEnabled(checked);
+    ui->filterBySize_Medium_radioButton->setEnabled(checked);
+    ui->filterBySize_Large_radioButton->setEnabled(checked);
+    ui->filterBySize_CustomInterval_radioButton->setEnabled(checked);
+
+    const bool customInterval = checked && ui->filterBySize_CustomInterval_radioButton->isChecked();
+    ui->filterBySize_CustomInterval_min_comboBox->setEnabled(customInterval);
+    ui->filterBySize_CustomInterval_max_comboBox->setEnabled(customInterval);
+    ui->filterBySize_CustomInterval_label1->setEnabled(customInterval);
+    ui->filterBySize_CustomInterval_label2->setEnabled(customInterval);
+    ui->filterBySize_CustomInterval_label3->setEnabled(customInterval);
+    ui->filterBySize_CustomInterval_label4->setEnabled(customInterval);
+
+    applyDatasetFilters();
 }
 void MainWindow::on_filterBySize_CustomInterval_radioButton_toggled(bool checked)
 {
-    if (checked) {
-        ui->filterBySize_CustomInterval_label1->setEnabled(true);
-        ui->filterBySize_CustomInterval_label2->setEnabled(true);
-        ui->filterBySize_CustomInterval_label3->setEnabled(true);
-        ui->filterBySize_CustomInterval_label4->setEnabled(true);
-        ui->filterBySize_CustomInterval_min_comboBox->setEnabled(true);
-        ui->filterBySize_CustomInterval_max_comboBox->setEnabled(true);
-    }
-    else {
-        ui->filterBySize_CustomInterval_label1->setEnabled(false);
-        ui->filterBySize_CustomInterval_label2->setEnabled(false);
-        ui->filterBySize_CustomInterval_label3->setEnabled(false);
-        ui->filterBySize_CustomInterval_label4->setEnabled(false);
-        ui->filterBySize_CustomInterval_min_comboBox->setEnabled(false);
-        ui->filterBySize_CustomInterval_max_comboBox->setEnabled(false);
-    }
+    ui->filterBySize_CustomInterval_label1->setEnabled(checked);
+    ui->filterBySize_CustomInterval_label2->setEnabled(checked);
+    ui->filterBySize_CustomInterval_label3->setEnabled(checked);
+    ui->filterBySize_CustomInterval_label4->setEnabled(checked);
+    ui->filterBySize_CustomInterval_min_comboBox->setEnabled(checked);
+    ui->filterBySize_CustomInterval_max_comboBox->setEnabled(checked);
 }
 void MainWindow::on_filterByVendor_checkBox_checkStateChanged(const Qt::CheckState &arg1)
 {
-    if (arg1 == Qt::Checked) {
-        ui->filterByVendor_pushButton->setEnabled(true);
-        ui->applyDatasetFilters_pushButton->setEnabled(true);
-        ui->clearDatasetFilters_pushButton->setEnabled(true);
-    }
-    else {
-        ui->filterByVendor_pushButton->setEnabled(false);
-        if (ui->filterBySize_checkBox->checkState() == Qt::Unchecked && ui->filterByNumber_checkBox->checkState() == Qt::Unchecked) {
-            ui->applyDatasetFilters_pushButton->setEnabled(false);
-            ui->clearDatasetFilters_pushButton->setEnabled(false);
-            on_clearDatasetFilters_pushButton_clicked();
-        }
-    }
+    ui->filterByVendor_pushButton->setEnabled(arg1 == Qt::Checked);
+
+    applyDatasetFilters();
 }
 void MainWindow::on_filterByVendor_pushButton_clicked()
 {
     auto* dialog = new VendorDialog(m_VendorFilterList);
     dialog->setAttribute(Qt::WA_DeleteOnClose);
     dialog->exec();
+
+    applyDatasetFilters();
 }
-void MainWindow::on_applyDatasetFilters_pushButton_clicked()
+void MainWindow::on_clearDatasetFilters_pushButton_clicked()
 {
-    on_clearDatasetFilters_pushButton_clicked();
+    // each checkbox handler reapplies the filters, the last one showing every dataset again
+    ui->filterByNumber_checkBox->setChecked(false);
+    ui->filterBySize_checkBox->setChecked(false);
+    ui->filterByVendor_checkBox->setChecked(false);
+}
 
-    int numberOfModels = 2;
-    double min = 350e6;
-    double max = 531e9;
+/**
+ * @brief Lists the datasets found under the HELM data path, grouped by task.
+ *
+ * The hierarchy comes from the dataset manifest, which only reads the run
+ * directories added since the last start. A task with a single dataset is
+ * listed as that dataset; the others list their datasets as children.
+ */
+void MainWindow::populateDatasetTree()
+{
+    ui->dataset_treeWidget->clear();
+    if (!m_datasetManifest.update(m_helmDataPath)) {
+        return;
+    }
 
-    if (ui->filterByVendor_checkBox->isChecked()) {
-        if (m_VendorFilterList.isEmpty()) {
-            PopUp("Select at least one vendor");
-            return;
-        }
+    QMap<QString, QList<DatasetManifest::Dataset>> datasetsByTask;
+    for (DatasetManifest::Dataset& dataset : m_datasetManifest.datasets()) {
+        datasetsByTask[DatasetManifest::taskName(dataset.name)].push_back(std::move(dataset));
     }
-    else {
-        m_VendorFilterList.clear();
+
+    const auto setDatasetData = [](QTreeWidgetItem* item, const DatasetManifest::Dataset& dataset) -> void {
+        item->setData(HPB::DTDatasetNameColumn, Qt::DisplayRole, dataset.name);
+        item->setData(HPB::DTNumberOfModels, Qt::DisplayRole, static_cast<int>(dataset.models.count()));
+        item->setData(HPB::DTLMListColumn, Qt::DisplayRole, QVariant::fromValue(dataset.models));
+    };
+
+    QList<QTreeWidgetItem*> items;
+    items.reserve(datasetsByTask.size());
+    for (const auto& [task, datasets] : datasetsByTask.asKeyValueRange()) {
+        auto *item = new QTreeWidgetItem();
+        item->setCheckState(HPB::DTDatasetNameColumn, Qt::Unchecked);
+        if (datasets.size() == 1) {
+            setDatasetData(item, datasets.first());
+            items.push_back(item);
+            continue;
+        }
+        item->setFlags(item->flags() | Qt::ItemIsAutoTristate);
+        item->setData(HPB::DTDatasetNameColumn, Qt::DisplayRole, task);
+        for (const DatasetManifest::Dataset& dataset : datasets) {
+            auto *child = new QTreeWidgetItem();
+            child->setCheckState(HPB::DTDatasetNameColumn, Qt::Unchecked);
+            setDatasetData(child, dataset);
+            item->addChild(child);
+        }
+        items.push_back(item);
     }
+    ui->dataset_treeWidget->addTopLevelItems(items);
+
+    applyDatasetFilters();
+}
+
+/**
+ * @brief Shows the datasets that pass the checked filters and hides the others.
+ *
+ * Each filter is turned into a set of acceptable models, so a dataset is tested
+ * with one AND and one popcount on its model set. A dataset passes if it was
+ * evaluated on enough models and on at least one model that is both of a
+ * selected vendor and of the selected size. Specifications are filtered
+ * individually and a dataset is hidden when all of them are.
+ */
+void MainWindow::applyDatasetFilters()
+{
+    const bool byNumber = ui->filterByNumber_checkBox->isChecked();
+    const bool bySize = ui->filterBySize_checkBox->isChecked();
+    const bool byVendor = ui->filterByVendor_checkBox->isChecked();
+    ui->clearDatasetFilters_pushButton->setEnabled(byNumber || bySize || byVendor);
 
-    if (ui->filterByNumber_checkBox->isChecked()) {
-        numberOfModels = ui->filterByNumber_modelNumber_spinBox->value();
+    size_t numberOfModels = 2;
+    double min = 350e6;
+    double max = 531e9;
+
+    if (byNumber) {
+        numberOfModels = static_cast<size_t>(ui->filterByNumber_modelNumber_spinBox->value());
     }
 
-    if (ui->filterBySize_checkBox->isChecked()) {
+    if (bySize) {
         switch(ui->filterBySize_buttonGroup->checkedId()) {
         case -1:
             break;
@@ -795,71 +584,38 @@ void MainWindow::on_applyDatasetFilters_pushButton_clicked()
         }
     }
 
-    const auto filter = [&](QTreeWidgetItem* item) -> void {
-        if (item == nullptr || item->isHidden()) {
-            return;
-        }
-
-        const bool has_enough_models = item->data(HPB::DTNumberOfModels, Qt::DisplayRole).toInt() >= numberOfModels;
-        bool parameters_in_range = false;
-        bool tested_on_vendor = false;
-
-        const QList<QVariant>& model_id_list_variant = item->data(HPB::DTLMListColumn, Qt::DisplayRole).toList();
-        for (const auto& model_id_variant : model_id_list_variant) {
-            int model_id = model_id_variant.toInt();
-            const auto model = std::ranges::find_if(m_Models, [&](const LanguageModel& model) { return model.id() == model_id; });
-            if ((m_VendorFilterList.isEmpty() || m_VendorFilterList.contains(static_cast<int>(model->vendor()))) && (model->parameters() >= min && model->parameters() < max)) {
-                parameters_in_range = true;
-                tested_on_vendor = true;
-                break;
-            }
-        }
-
-        if (has_enough_models && parameters_in_range && tested_on_vendor) {
-            return;
-        }
-
-        item->setFlags(item->flags() & (~Qt::ItemIsUserCheckable));
-        item->setHidden(true);
-
-        if (item->parent() == nullptr) {
-            return;
-        }
+    HPB::ModelSet acceptedModels = HPB::modelsBySize(min, max);
+    // no vendor selected yet means no vendor restriction
+    if (byVendor && !m_VendorFilterList.isEmpty()) {
+        acceptedModels &= HPB::modelsByVendor(m_VendorFilterList);
+    }
 
-        QTreeWidgetItem* parent = item->parent();
-        const int childCount = parent->childCount();
-        bool all_children_disabled = true;
-        for (int i : _range(0, childCount)) {
-            if (!parent->child(i)->isHidden()) {
-                all_children_disabled = false;
-                break;
-            }
-        }
-        if (all_children_disabled) {
-            parent->setFlags(parent->flags() & (~Qt::ItemIsUserCheckable));
-            parent->setHidden(true);
-        }
+    const bool filtering = byNumber || bySize || byVendor;
+    const auto passes = [&](const QTreeWidgetItem* item) -> bool {
+        const auto models = item->data(HPB::DTLMListColumn, Qt::DisplayRole).value<HPB::ModelSet>();
+        return !filtering || (models.count() >= numberOfModels && (models & acceptedModels).any());
+    };
+    const auto setShown = [](QTreeWidgetItem* item, const bool shown) -> void {
+        item->setFlags(shown ? item->flags() | Qt::ItemIsUserCheckable : item->flags() & ~Qt::ItemIsUserCheckable);
+        item->setHidden(!shown);
     };
 
-    transformDatasetTree(ui->dataset_treeWidget, filter);
-}
-void MainWindow::on_clearDatasetFilters_pushButton_clicked()
-{
-    const auto enableAllDatasets = [&](QTreeWidgetItem* item) -> void {
-        if (item == nullptr) {
-            return;
+    const int datasetCount = ui->dataset_treeWidget->topLevelItemCount();
+    for (int i : _range(0, datasetCount)) {
+        QTreeWidgetItem* dataset = ui->dataset_treeWidget->topLevelItem(i);
+        if (dataset->childCount() == 0) {
+            setShown(dataset, passes(dataset));
+            continue;
         }
-        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
-        item->setHidden(false);
-
-        if (item->parent() != nullptr) {
-            QTreeWidgetItem* parent = item->parent();
-            parent->setFlags(item->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsAutoTristate);
-            parent->setHidden(false);
+        bool anySpecificationShown = false;
+        for (int j : _range(0, dataset->childCount())) {
+            QTreeWidgetItem* specification = dataset->child(j);
+            const bool shown = passes(specification);
+            setShown(specification, shown);
+            anySpecificationShown = anySpecificationShown || shown;
         }
-    };
-
-    transformDatasetTree(ui->dataset_treeWidget, enableAllDatasets);
+        setShown(dataset, anySpecificationShown);
+    }
 }
 
 /****************************
@@ -872,6 +628,10 @@ void MainWindow::on_search_pushButton_clicked()
      * CHECK SOME PRE-REQUISITES *
      *****************************/
 
+    if (m_activeJob != nullptr) {
+        return;
+    }
+
     if (ui->HELM_Data_lineEdit->text().isEmpty()) {
         Warn("No HELM data available");
         return;
@@ -882,6 +642,8 @@ void MainWindow::on_search_pushButton_clicked()
         }
     }
 
+    const TraceSpan span("on_search_pushButton_clicked");
+
     /*******************************
      * CHECK QUERY WELL-FORMEDNESS *
      *******************************/
@@ -896,13 +658,13 @@ void MainWindow::on_search_pushButton_clicked()
      * GET DATASETS TO ADD TO PROMPT TREE *
      **************************************/
 
-    const QStringList datasetsToBeAdded = getSelectedDatasetNames(ui->dataset_treeWidget);
+    QStringList datasetsToBeAdded = getSelectedDatasetNames(ui->dataset_treeWidget);
 
     /****************************************************
      * GET DIRECTORIES WHERE INSTANCE FILES ARE LOCATED *
      ****************************************************/
 
-    const QStringList taskDirs = getHelmTaskDirs(datasetsToBeAdded, m_helmDataPath);
+    const QStringList taskDirs = resolveTaskDirs(datasetsToBeAdded);
 
     Q_ASSERT_X(taskDirs.size() == datasetsToBeAdded.size(), "Taks directories and selected datasets have different cardinalities", "mainwindow.cpp");
 
@@ -910,37 +672,40 @@ void MainWindow::on_search_pushButton_clicked()
      * PARSE QUERY AND SET SEARCH CASE-SENSITIVITY *
      ***********************************************/
 
-    const QList<QPair<QList<QString>, QList<QString>>> queries = getQueries(searchTerm);
     const bool searchIsCaseSensitive = ui->search_case_sensitive_checkBox->isChecked();
     const bool searchIsRegex = ui->searchRegex_checkBox->isChecked();
+    const CompiledQuery query(getQueryExpression(searchTerm), searchIsCaseSensitive, searchIsRegex);
+    if (!query.isValid()) {
+        Warn("Search query contains an invalid regular expression:\n" + query.errorString());
+        return;
+    }
 
     /************************
      * FINALLY, ADD PROMPTS *
      ************************/
 
-    const qsizetype taskDirscount = taskDirs.count();
-    for (qsizetype j : _range(0,taskDirscount)) {
-        const QString& dataset = datasetsToBeAdded.at(j);
-
-        const QJsonDocument instances = getTaskInstances(taskDirs.at(j), m_helmDataPath);
-        if (instances.isEmpty()) {
-            return;
+    const auto showSearchOutcome = [this](bool cancelled) -> void {
+        if (m_promptModel->rowCount() > 0) {
+            ui->delete_pushButton->setEnabled(true);
+            ui->clear_pushButton->setEnabled(true);
+            ui->selectPrompt_pushButton->setEnabled(true);
+            ui->deselectPrompt_pushButton->setEnabled(true);
+            ui->assignCID_pushButton->setEnabled(true);
+            ui->clearCID_pushButton->setEnabled(true);
+        }
+        else if (!cancelled) {
+            PopUp("No match found in selected datasets");
         }
+    };
 
-        addPromptsToTree(dataset, instances, queries, searchIsCaseSensitive, searchIsRegex, ui->prompts_treeWidget);
+    if (datasetsToBeAdded.isEmpty()) {
+        showSearchOutcome(false);
+        return;
     }
 
-    if (ui->prompts_treeWidget->topLevelItemCount() > 0) {
-        ui->delete_pushButton->setEnabled(true);
-        ui->clear_pushButton->setEnabled(true);
-        ui->selectPrompt_pushButton->setEnabled(true);
-        ui->deselectPrompt_pushButton->setEnabled(true);
-        ui->assignCID_pushButton->setEnabled(true);
-        ui->clearCID_pushButton->setEnabled(true);
-    }
-    else {
-        PopUp("No match found in selected datasets");
-    }
+    connect(m_searchJob, &SearchJob::finished, this, showSearchOutcome, Qt::SingleShotConnection);
+    startJob(m_searchJob, "Searching");
+    m_searchJob->start(datasetsToBeAdded, taskDirs, m_helmDataPath, m_cachePath, query, m_useFullTextIndex);
 }
 void MainWindow::on_filter_pushButton_clicked()
 {
@@ -948,7 +713,11 @@ void MainWindow::on_filter_pushButton_clicked()
      * CHECK SOME PRE-REQUISITES *
      *****************************/
 
-    if (ui->prompts_treeWidget->topLevelItemCount() == 0){
+    if (m_activeJob != nullptr) {
+        return;
+    }
+
+    if (m_promptModel->rowCount() == 0){
         Warn("Nothing to filter!");
         return;
     }
@@ -972,40 +741,67 @@ void MainWindow::on_filter_pushButton_clicked()
      * PARSE QUERY AND SET SEARCH CASE-SENSITIVITY *
      ***********************************************/
 
-    const QList<QPair<QList<QString>, QList<QString>>> queries = getQueries(filter_term);
     const bool filterIsCaseSensitive = ui->filter_case_sensitive_checkBox->isChecked();
     const bool filterIsRegex = ui->filterRegex_checkBox->isChecked();
+    const CompiledQuery query(getQueryExpression(filter_term), filterIsCaseSensitive, filterIsRegex);
+    if (!query.isValid()) {
+        Warn("Filter query contains an invalid regular expression:\n" + query.errorString());
+        return;
+    }
 
     /***************************
      * FINALLY, FILTER PROMPTS *
      ***************************/
 
-    const auto filter_prompt = [&](QTreeWidgetItem* item) -> void {
-        if (item == nullptr) {
+    // the prompt tree stays disabled while the job runs, so the snapshot's prompts remain in it
+    const QList<TaskPrompts> prompts = groupPromptsByTask(m_promptModel->store(), m_promptModel->store().attachedPrompts());
+
+    const auto removeMatchingPrompts = [this](bool cancelled) -> void {
+        if (cancelled) {
             return;
         }
-        const QString& prompt = getPrompt(item);
-        if (matches(prompt, queries, filterIsCaseSensitive, filterIsRegex)) {
-            QTreeWidgetItem* parent = item->parent();
-            parent->removeChild(item);
-            delete item;
+        const TraceSpan span("removeMatchingPrompts");
+        QList<PromptStore::Node> nodes;
+        nodes.reserve(m_filterJob->matchingPrompts().size());
+        for (const PromptStore::PromptId prompt : m_filterJob->matchingPrompts()) {
+            nodes.push_back({ PromptStore::Node::Prompt, prompt });
+        }
+        if (nodes.isEmpty()) {
+            return;
+        }
+
+        // one batch, and one undo step that puts every filtered prompt back
+        m_commandLog->remove(nodes);
+        if (m_promptModel->rowCount() == 0) {
+            ui->clear_pushButton->setEnabled(false);
         }
     };
 
-    transformPromptTree(ui->prompts_treeWidget, filter_prompt);
+    connect(m_filterJob, &FilterJob::finished, this, removeMatchingPrompts, Qt::SingleShotConnection);
+    startJob(m_filterJob, "Filtering");
+    m_filterJob->start(prompts, m_cachePath, query);
+}
+
+void MainWindow::on_workerThreads_spinBox_valueChanged(int value)
+{
+    m_workerThreadCount = value;
+    applyWorkerThreadCount();
+}
+
+void MainWindow::on_searchIndex_checkBox_toggled(bool checked)
+{
+    m_useFullTextIndex = checked;
 }
 
 void MainWindow::on_selectPrompt_pushButton_clicked()
 {
-    for (QTreeWidgetItem* currentItem : ui->prompts_treeWidget->selectedItems()) {
-        setSelectedStatus(currentItem, true);
-    }
+    const QModelIndexList selectedRows = ui->prompts_treeView->selectionModel()->selectedRows();
+    m_commandLog->setSelected(m_promptModel->prompts(selectedRows), true);
 }
 void MainWindow::on_deselectPrompt_pushButton_clicked()
 {
-    for (QTreeWidgetItem* currentItem : ui->prompts_treeWidget->selectedItems()) {
-        setSelectedStatus(currentItem, false);
-    }
+    const QModelIndexList selectedRows = ui->prompts_treeView->selectionModel()->selectedRows();
+    m_commandLog->setSelected(m_promptModel->prompts(selectedRows), false);
 }
 void MainWindow::on_assignCID_pushButton_clicked()
 {
@@ -1025,15 +821,8 @@ void MainWindow::on_assignCID_pushButton_clicked()
     const QString CID = dialog->textValue();
 
     if (result) {
-        if (!m_CIDList.contains(CID)) {
-            m_CIDList.push_back(CID);
-            QStringListModel* model = dynamic_cast<QStringListModel*>(m_CIDCompleter->model());
-            model->setStringList(m_CIDList);
-        }
-        const QList<QTreeWidgetItem*> selectedPrompts = ui->prompts_treeWidget->selectedItems();
-        for (QTreeWidgetItem* prompt : selectedPrompts) {
-            setCID(prompt, CID);
-        }
+        const QModelIndexList selectedRows = ui->prompts_treeView->selectionModel()->selectedRows();
+        m_commandLog->setCid(m_promptModel->prompts(selectedRows), CID);
     }
 
     delete dialog;
@@ -1041,71 +830,56 @@ void MainWindow::on_assignCID_pushButton_clicked()
 }
 void MainWindow::on_clearCID_pushButton_clicked()
 {
-    const QList<QTreeWidgetItem*> selectedPrompts = ui->prompts_treeWidget->selectedItems();
-    for (QTreeWidgetItem* prompt : selectedPrompts) {
-        setCID(prompt, "");
-    }
+    const QModelIndexList selectedRows = ui->prompts_treeView->selectionModel()->selectedRows();
+    m_commandLog->setCid(m_promptModel->prompts(selectedRows), QString());
 }
 void MainWindow::on_delete_pushButton_clicked()
 {
-    for (QTreeWidgetItem* currentItem : ui->prompts_treeWidget->selectedItems()) {
-        QTreeWidgetItem* currentParent = currentItem->parent(); // may be nullptr
-        m_undoStack.push({ currentItem, currentParent });
-
-        if (currentParent == nullptr) { // currentItem is top level dataset
-            const int index = ui->prompts_treeWidget->indexOfTopLevelItem(currentItem);
-            (void)ui->prompts_treeWidget->takeTopLevelItem(index);
-            continue;
-        }
+    if (m_activeJob != nullptr) {
+        return;
+    }
 
-        currentParent->removeChild(currentItem);
+    // removing a row shifts the rows after it, so the nodes are identified first
+    QList<PromptStore::Node> nodes;
+    for (const QModelIndex& index : ui->prompts_treeView->selectionModel()->selectedRows()) {
+        nodes.push_back(m_promptModel->node(index));
     }
 
-    if (ui->prompts_treeWidget->topLevelItemCount() == 0) {
+    m_commandLog->remove(nodes);
+
+    if (m_promptModel->rowCount() == 0) {
         ui->clear_pushButton->setEnabled(false);
     }
-
-    ui->undo_pushButton->setEnabled(true);
 }
 void MainWindow::on_undo_pushButton_clicked()
 {
-    auto [item, parent] = m_undoStack.pop();
-    if (parent == nullptr) {
-        ui->prompts_treeWidget->addTopLevelItem(item);
+    if (m_activeJob != nullptr || !m_commandLog->canUndo()) {
         return;
     }
 
-    parent->addChild(item);
-
-    m_redoStack.push({item, parent});
-    ui->redo_pushButton->setEnabled(true);
-
-    if (m_undoStack.isEmpty()) {
-        ui->undo_pushButton->setEnabled(false);
-    }
+    // a dataset or prompt added again after the deletion takes the place of the deleted one
+    m_commandLog->undo();
+    ui->clear_pushButton->setEnabled(m_promptModel->rowCount() > 0);
 }
 void MainWindow::on_redo_pushButton_clicked()
 {
-    auto [item, parent] = m_redoStack.pop();
-    m_undoStack.push({ item, parent });
-
-    if (parent == nullptr) {
-        const int index = ui->prompts_treeWidget->indexOfTopLevelItem(item);
-        (void)ui->prompts_treeWidget->takeTopLevelItem(index);
+    if (m_activeJob != nullptr || !m_commandLog->canRedo()) {
         return;
     }
 
-    parent->removeChild(item);
-
-    ui->undo_pushButton->setEnabled(true);
-
-    if (m_redoStack.isEmpty()) {
-        ui->redo_pushButton->setEnabled(false);
-    }
+    m_commandLog->redo();
+    ui->clear_pushButton->setEnabled(m_promptModel->rowCount() > 0);
 }
 void MainWindow::on_clear_pushButton_clicked()
 {
-    ui->prompts_treeWidget->clear();
+    if (m_activeJob != nullptr) {
+        return;
+    }
+
+    // node ids are only valid until the store is cleared
+    m_promptModel->clear();
+    m_promptTexts.clear();
+    m_commandLog->clear();
     ui->prompt_plainTextEdit->clear();
     ui->references_plainTextEdit->clear();
     ui->delete_pushButton->setEnabled(false);
@@ -1118,60 +892,76 @@ void MainWindow::on_clear_pushButton_clicked()
 
 void MainWindow::on_filterPromptsByCID_pushButton_clicked()
 {
-    const QString cid = ui->filterPromptsByCID_lineEdit->text();
-
-    const auto filter = [&](QTreeWidgetItem* item) -> void {
-        if (!isPrompt(item)) {
-            const int childCount = item->childCount();
-            bool allChildrenHidden = true;
-            for (int i : _range(0, childCount)) {
-                if (!item->child(i)->isHidden()) {
-                    allChildrenHidden = false;
-                    break;
-                }
+    m_promptModel->setCidFilter(ui->filterPromptsByCID_lineEdit->text());
+    ui->prompts_treeView->expandAll();
+}
+void MainWindow::on_clearPromptFilter_pushButton_clicked()
+{
+    m_promptModel->clearCidFilter();
+}
+
+/**
+ * @brief Refreshes the CID completer and the per-CID prompt counts from the store's CID index.
+ *
+ * Prompts in removed datasets are not counted.
+ */
+void MainWindow::updateCidCounts()
+{
+    const PromptStore& store = m_promptModel->store();
+
+    QStringList cids;
+    QList<QTreeWidgetItem*> items;
+    for (const qint32 cid : _range(1, store.cidCount())) {
+        cids.push_back(store.cidName(cid));
+
+        auto* item = new QTreeWidgetItem({ store.cidName(cid) });
+        qint32 total = 0;
+        for (const auto [group, count] : store.cidGroupCounts(cid).asKeyValueRange()) {
+            const PromptStore::BaseId base = store.groupBase(group);
+            if (store.isRemoved({ PromptStore::Node::Group, group }) || store.isRemoved({ PromptStore::Node::Base, base })) {
+                continue;
             }
-            if (allChildrenHidden) {
-                item->setHidden(true);
+            QString dataset = store.baseName(base);
+            if (!store.groupSpec(group).isEmpty()) {
+                dataset += ":" + store.groupSpec(group);
             }
-            return;
-        }
-
-        if (getCID(item) != cid) {
-            item->setHidden(true);
+            item->addChild(new QTreeWidgetItem({ dataset, QString::number(count) }));
+            total += count;
         }
-        else {
-            item->setHidden(false);
+        if (total == 0) {
+            delete item;
+            continue;
         }
-    };
-    transformPromptTree(ui->prompts_treeWidget, filter);
+        item->setText(1, QString::number(total));
+        item->sortChildren(0, Qt::AscendingOrder);
+        items.push_back(item);
+    }
 
-    ui->prompts_treeWidget->expandAll();
-}
-void MainWindow::on_clearPromptFilter_pushButton_clicked()
-{
-    const auto showAll= [&](QTreeWidgetItem* item) -> void {
-        item->setHidden(false);
+    auto* model = dynamic_cast<QStringListModel*>(m_CIDCompleter->model());
+    model->setStringList(cids);
 
-    };
-    transformPromptTree(ui->prompts_treeWidget, showAll);
+    ui->cidCounts_treeWidget->clear();
+    ui->cidCounts_treeWidget->addTopLevelItems(items);
 }
 
-void MainWindow::on_prompts_treeWidget_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous)
+void MainWindow::showCurrentPrompt(const QModelIndex& current)
 {
-    if (current == nullptr) {
+    if (!current.isValid()) {
         return;
     }
 
-    if (!isPrompt(current)) {
+    const PromptStore::PromptId prompt = m_promptModel->prompt(current);
+    if (prompt < 0) {
         ui->delete_pushButton->setEnabled(true);
         return;
     }
 
+    const PromptTexts texts = m_promptTexts.texts(m_promptModel->store(), prompt, m_cachePath);
     ui->delete_pushButton->setEnabled(false);
     ui->prompt_plainTextEdit->clear();
     ui->references_plainTextEdit->clear();
-    ui->prompt_plainTextEdit->insertPlainText(getPrompt(current));
-    ui->references_plainTextEdit->insertPlainText(getReferences(current));
+    ui->prompt_plainTextEdit->insertPlainText(texts.prompt);
+    ui->references_plainTextEdit->insertPlainText(texts.references);
 }
 
 /**************************
@@ -1193,17 +983,17 @@ void MainWindow::on_export_pushButton_clicked()
      * This function is somewhat complex. Here's the layout:
      *
      * 1. Ensure that export pre-requisites are met
-     * 2. Open file for export
-     * 3. Load PNYX's `helm_tests.json` file, with HELM test data
-     * 4. Construct JSON document for custom compilation
-     * 5. Write to file and notify the user
+     * 2. Load PNYX's `helm_tests.json` file, with HELM test data
+     * 3. Collect the (sub)datasets with selected prompts, and check the metrics of their CIDs
+     * 4. Stream them to the file on the thread pool, and notify the user
      */
 
     /*******************************************
      * 1. Ensure export pre-requisites are met *
      *******************************************/
 
-    if (ui->prompts_treeWidget->topLevelItemCount() == 0) {
+    const PromptStore& store = m_promptModel->store();
+    if (store.attachedPrompts().isEmpty()) {
         Warn("Nothing to export");
         return;
     }
@@ -1216,105 +1006,190 @@ void MainWindow::on_export_pushButton_clicked()
         }
     }
 
-    /***************************
-     * 2. open file for export *
-     ***************************/
-
-    if (!QDir(m_outputPath).exists()) {
-        QDir().mkdir(m_outputPath);
-    }
-
-    QFile outputFile(m_outputPath + "/" + m_jsonFileName + ".json");
-
-    if (!outputFile.open(QIODevice::WriteOnly)) {
-        Warn("Failed to open " + m_jsonFileName +  " for writing");
-        return;
-    }
+    const TraceSpan span("on_export_pushButton_clicked");
 
     /***************************
-     * 3. Load helm_tests.json *
+     * 2. Load helm_tests.json *
      ***************************/
 
-    QJsonObject const helmDataJson = loadHelmDataConfig(m_helmDataJSON);
-    if (helmDataJson.isEmpty()) {
+    // parsed again only when the file changed since the last export
+    if (!m_helmDataConfig.update(m_helmDataJSON)) {
         Warn("Helm Dataset Configuration empty!\nAborting export.");
         return;
     }
 
-    /********************************************
-     * 4. Construct JSON for custom compilation *
-     ********************************************/
-
-    // TO-DO
-    // check for incompatible metrics in custom dataset
-    // notify CID change if found
+    /*************************************
+     * 3. Collect the datasets to export *
+     *************************************/
 
-    QJsonDocument customCompilation;
+    const QList<ExportDataset> datasets = exportDatasets(store, m_helmDataConfig);
 
-    /*
-     * Output JSON structure:
-     *
-     * customCompilation
-     *    +- mainObject
-     *         +- compilationName
-     *         +- datasetArray
-     */
+    // prompts sharing a CID are scored together, so they should come from datasets with the same metric
+    if (!m_DontShowMetricConflictMessage) {
+        const QStringList conflicts = incompatibleCids(store, datasets);
+        if (!conflicts.isEmpty()) {
+            const QString text = "Some CIDs group prompts of datasets with different metrics:\n\n" + conflicts.join("\n");
+            if (Ask(text, "Consider assigning them different CIDs. Export anyway?", m_DontShowMetricConflictMessage) == QMessageBox::No) {
+                return;
+            }
+        }
+    }
 
-    QJsonObject mainObject;
-    QJsonArray datasetArray;
+    /**************************************
+     * 4. Write to file in the background *
+     **************************************/
 
-    /*
-     * datasetArray structure:
-     *
-     * datasetArray
-     *   +- anonymous_obj
-     *        +- dataset_base
-     *             +- dataset_spec
-     *             +- split
-     *             +- metric
-     *             +- samples
-     *                  +- CID
-     *                  +- CID
-     *   +- anonymous_obj
-     *        +- ...
-     *   +- ...
-     */
+    if (!QDir(m_outputPath).exists()) {
+        QDir().mkdir(m_outputPath);
+    }
 
-    // construct the array
+    const auto notifyExportOutcome = [this](bool cancelled) -> void {
+        if (!m_exportJob->errorString().isEmpty()) {
+            Warn(m_exportJob->errorString());
+        }
+        else if (!cancelled) {
+            PopUp("JSON exported");
+        }
+    };
 
-    const int topLevelDatasetCount = ui->prompts_treeWidget->topLevelItemCount();
-    for (int i : _range(0, topLevelDatasetCount)) {
-        const QTreeWidgetItem* dataset = ui->prompts_treeWidget->topLevelItem(i);
+    connect(m_exportJob, &BackgroundJob::finished, this, notifyExportOutcome, Qt::SingleShotConnection);
+    startJob(m_exportJob, "Exporting");
+    m_exportJob->start(&store, datasets, m_outputPath + "/" + m_jsonFileName + ".json", m_compilationName);
+}
 
-        if (!hasSpecifications(dataset)) {
-            if (hasSelectedPrompts(dataset)) {
-                datasetArray.append(generateCustomDataset(dataset, getName(dataset), {}, helmDataJson));
-            }
-            continue;
+namespace {
+    QString formatDuration(qint64 msecs)
+    {
+        const qint64 seconds = msecs / 1000;
+        const QString minutesAndSeconds = QString("%1:%2").arg((seconds / 60) % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+        if (seconds < 3600) {
+            return minutesAndSeconds;
         }
+        return QString::number(seconds / 3600) + ":" + minutesAndSeconds;
+    }
+} // namespace
 
-        const int subDatasetCount = dataset->childCount();
-        for (int i : _range(0, subDatasetCount)) {
-            const QTreeWidgetItem* subDataset = dataset->child(i);
-            if (hasSelectedPrompts(subDataset)) {
-                datasetArray.append(generateCustomDataset(subDataset, getName(dataset), getName(subDataset), helmDataJson));
-            }
+void MainWindow::addDatasetMatches(const QList<DatasetMatches>& matches)
+{
+    const TraceSpan span("addDatasetMatches");
+
+    // one repaint for the whole batch instead of one per inserted dataset
+    ui->prompts_treeView->setUpdatesEnabled(false);
+    for (const DatasetMatches& datasetMatches : matches) {
+        if (!datasetMatches.error.isEmpty()) {
+            m_jobErrors.push_back(datasetMatches.error);
         }
+        addPromptsToTree(datasetMatches.task, datasetMatches.prompts, m_promptModel);
+    }
+    ui->prompts_treeView->setUpdatesEnabled(true);
+}
+void MainWindow::startJob(BackgroundJob* job, const QString& description)
+{
+    m_activeJob = job;
+    m_jobDescription = description;
+    m_jobErrors.clear();
+
+    ui->search_pushButton->setEnabled(false);
+    ui->filter_pushButton->setEnabled(false);
+    ui->loadFromFile_pushButton->setEnabled(false);
+    ui->HELM_Data_pushButton->setEnabled(false);
+    ui->dataset_treeWidget->setEnabled(false);
+    ui->export_pushButton->setEnabled(false);
+    // searches only append to the tree, so it can still be browsed; filtering works on a snapshot of its items
+    ui->prompts_treeView->setEnabled(job != m_filterJob);
+    // exporting reads the prompt store itself, so no prompt may be edited meanwhile
+    ui->groupBox_3->setEnabled(job != m_exportJob);
+
+    m_progressBar->setValue(0);
+    m_progressLabel->setText(description + "...");
+    m_progressLabel->show();
+    m_progressBar->show();
+    m_cancelJobButton->show();
+}
+void MainWindow::updateJobProgress(qint64 done, qint64 total)
+{
+    if (m_activeJob == nullptr) {
+        return;
     }
 
-    // put everything together
+    const int progressScale = 1000;
+    m_progressBar->setValue(total > 0 ? static_cast<int>(done * progressScale / total) : 0);
 
-    mainObject.insert("compilation_name", m_compilationName);
-    mainObject.insert("datasets", datasetArray);
-    customCompilation.setObject(mainObject);
+    QString status = m_jobDescription;
+    if (m_activeJob == m_searchJob) {
+        status += QString(": %1/%2 datasets").arg(m_searchJob->datasetsDone()).arg(m_searchJob->datasetCount());
+    }
+    const qint64 remaining = m_activeJob->remainingMsecs();
+    if (remaining >= 0) {
+        status += " (" + formatDuration(remaining) + " left)";
+    }
+    m_progressLabel->setText(status);
+}
+void MainWindow::jobFinished(bool cancelled)
+{
+    if (m_activeJob == m_filterJob) {
+        m_jobErrors += m_filterJob->errors();
+    }
+    m_activeJob = nullptr;
+
+    m_progressLabel->hide();
+    m_progressBar->hide();
+    m_cancelJobButton->hide();
+
+    ui->search_pushButton->setEnabled(true);
+    ui->filter_pushButton->setEnabled(true);
+    ui->loadFromFile_pushButton->setEnabled(true);
+    ui->HELM_Data_pushButton->setEnabled(true);
+    ui->dataset_treeWidget->setEnabled(true);
+    ui->export_pushButton->setEnabled(true);
+    ui->prompts_treeView->setEnabled(true);
+    ui->groupBox_3->setEnabled(true);
+
+    if (cancelled) {
+        const int messageDuration = 3000;
+        ui->statusbar->showMessage(m_jobDescription + " cancelled", messageDuration);
+    }
+    if (!m_jobErrors.isEmpty()) {
+        Warn(m_jobErrors.join("\n\n"));
+    }
+}
+void MainWindow::applyWorkerThreadCount()
+{
+    m_searchPool.setMaxThreadCount(m_workerThreadCount > 0 ? m_workerThreadCount : QThread::idealThreadCount());
+}
 
-    /****************************************
-     * 5. Write to file and notify the user *
-     ****************************************/
+/**
+ * @brief Looks up the task directory of each dataset in the HELM directory index.
+ *
+ * Datasets without a run directory under the HELM data path are removed from
+ * the list, and the user is told which ones were skipped.
+ *
+ * @param datasets The dataset names; datasets that cannot be resolved are removed.
+ * @return QStringList The task directory of each remaining dataset, in the same order.
+ */
+QStringList MainWindow::resolveTaskDirs(QStringList& datasets)
+{
+    m_helmDirectoryIndex.update(m_helmDataPath);
+    const QStringList allTaskDirs = getHelmTaskDirs(datasets, m_helmDirectoryIndex);
+
+    QStringList found;
+    QStringList taskDirs;
+    QStringList missing;
+    for (const qsizetype i : _range(qsizetype(0), datasets.size())) {
+        if (allTaskDirs.at(i).isEmpty()) {
+            missing.push_back(datasets.at(i));
+            continue;
+        }
+        found.push_back(datasets.at(i));
+        taskDirs.push_back(allTaskDirs.at(i));
+    }
 
-    outputFile.write(customCompilation.toJson());
+    if (!missing.isEmpty()) {
+        Warn("No HELM run directory found for:\n" + missing.join("\n"));
+    }
 
-    PopUp("JSON exported");
+    datasets = std::move(found);
+    return taskDirs;
 }
 
 bool MainWindow::exportPrerequisitesMet() const
@@ -1330,6 +1205,9 @@ int MainWindow::launchExportOptionsDialog()
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
+    if (m_activeJob != nullptr) {
+        m_activeJob->cancel();
+    }
     writeSettings();
     event->accept();
 }
@@ -1344,6 +1222,11 @@ void MainWindow::writeSettings()
     settings.setValue("HELM_JSON", m_helmDataJSON);
     settings.setValue("IMPORT_JSON_FOLDER", m_importFileFolder);
     settings.setValue("DontShowAgainSearch", m_DontShowEmptySearchMessage);
+    settings.setValue("DontShowAgainMetricConflict", m_DontShowMetricConflictMessage);
+    settings.setValue("WorkerThreads", m_workerThreadCount);
+    settings.setValue("CachePath", m_cachePath);
+    settings.setValue("UseFullTextIndex", m_useFullTextIndex);
+    settings.setValue("UndoMemoryLimitMB", m_undoMemoryLimitMB);
 }
 void MainWindow::readSettings()
 {
@@ -1358,6 +1241,14 @@ void MainWindow::readSettings()
 
     m_compilationName = settings.value("CompilationName").toString();
     m_DontShowEmptySearchMessage = settings.value("DontShowAgainSearch").toBool();
+    m_DontShowMetricConflictMessage = settings.value("DontShowAgainMetricConflict").toBool();
+    m_workerThreadCount = std::max(settings.value("WorkerThreads", 0).toInt(), 0);
+
+    // an empty CachePath disables the instance cache
+    const QString defaultCachePath = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/HELMPromptBrowser";
+    m_cachePath = settings.value("CachePath", defaultCachePath).toString();
+    m_useFullTextIndex = settings.value("UseFullTextIndex", false).toBool();
+    m_undoMemoryLimitMB = std::max(settings.value("UndoMemoryLimitMB", 64).toInt(), 0);
 
     if (!QDir(m_importFileFolder).exists()) {
         m_importFileFolder = QStandardPaths::displayName(QStandardPaths::DocumentsLocation);
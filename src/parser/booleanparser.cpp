@@ -10,15 +10,20 @@ BooleanParser::BooleanParser()
 bool BooleanParser::parse(const QString& formula, Expression& expr)
 {
     expr.clear();
+    m_Expression = &expr;
     tokenize(formula);
-    return sentence(expr);
+
+    Expression::NodeId root = Expression::NoNode;
+    const bool result = sentence(root);
+    expr.setRoot(root);
+    m_Expression = nullptr;
+    return result;
 }
 
 bool BooleanParser::check(const QString& formula)
 {
     Expression expr;
-    tokenize(formula);
-    return sentence(expr);
+    return parse(formula, expr);
 }
 
 namespace {
@@ -115,71 +120,63 @@ bool BooleanParser::match(TokenType type)
     return true;
 }
 
-bool BooleanParser::sentence(Expression& expr)
+bool BooleanParser::sentence(Expression::NodeId& node)
 {
     if (!match(TokenType::START_SYMBOL)) {
         return false;
     }
-    if (!disjunction(expr)) {
+    if (!disjunction(node)) {
         return false;
     }
     return match(TokenType::END_SYMBOL);
 }
 
-bool BooleanParser::disjunction(Expression& expr)
+bool BooleanParser::disjunction(Expression::NodeId& node)
 {
-    if (!conjunction(expr)) {
+    if (!conjunction(node)) {
         return false;
     }
     while (match(TokenType::OR)) {
-        Expression new_expr(Operator::OR, "", { expr });
-        const bool result = conjunction(expr);
-        if (result) {
-            new_expr.addOperand(expr);
-            expr = new_expr;
-            continue;
+        Expression::NodeId rhs = Expression::NoNode;
+        if (!conjunction(rhs)) {
+            return false;
         }
-        return result;
+        node = m_Expression->addNode(Operator::OR, node, rhs);
     }
     return true;
 }
 
-bool BooleanParser::conjunction(Expression& expr)
+bool BooleanParser::conjunction(Expression::NodeId& node)
 {
-    if (!negation(expr)) {
+    if (!negation(node)) {
         return false;
     }
     while (match(TokenType::AND)) {
-        Expression new_expr(Operator::AND, "", { expr });
-        const bool result = negation(expr);
-        if (result) {
-            new_expr.addOperand(expr);
-            expr = new_expr;
-            continue;
+        Expression::NodeId rhs = Expression::NoNode;
+        if (!negation(rhs)) {
+            return false;
         }
-        return result;
+        node = m_Expression->addNode(Operator::AND, node, rhs);
     }
     return true;
 }
 
-bool BooleanParser::negation(Expression& expr)
+bool BooleanParser::negation(Expression::NodeId& node)
 {
     if (match(TokenType::IDENTIFIER)) {
-        expr = Expression(Operator::NIL, m_TokenList.at(m_Index - 1).first);
-        expr.addOperand(expr);
+        node = m_Expression->addAtom(m_TokenList.at(m_Index - 1).first);
         return true;
     }
     if (match(TokenType::NOT)) {
-        if (!negation(expr)) {
+        Expression::NodeId scope = Expression::NoNode;
+        if (!negation(scope)) {
             return false;
         }
-        Expression new_expr = Expression(Operator::NOT);
-        new_expr.addOperand(expr);
-        expr = new_expr;
+        node = m_Expression->addNode(Operator::NOT, scope);
         return true;
     }
     if (match(TokenType::LPAREN)) {
-        if (!disjunction(expr)) {
+        if (!disjunction(node)) {
             return false;
         }
         return match(TokenType::RPAREN);
@@ -19,16 +19,17 @@ public:
 private:
     void advance();
     bool match(TokenType type);
-    bool sentence(Expression& expr);
-    bool disjunction(Expression& expr);
-    bool conjunction(Expression& expr);
-    bool negation(Expression& expr);
+    bool sentence(Expression::NodeId& node);
+    bool disjunction(Expression::NodeId& node);
+    bool conjunction(Expression::NodeId& node);
+    bool negation(Expression::NodeId& node);
 
     void tokenize(const QString& formula);
 
     int m_Index;
     TokenType m_Sym;
     QList<QPair<QString, TokenType>> m_TokenList;
+    Expression* m_Expression = nullptr;
 
     inline static const QMap<TokenType, QString> TokenTypeName = {
         { TokenType::START_SYMBOL, QString("<S>") },
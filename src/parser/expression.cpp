@@ -1,58 +1,87 @@
 #include "expression.hpp"
 
-Expression::Expression(Operator op, QString literal, const QList<Expression>& children)
-    : m_Operator(op), m_Literal(std::move(literal))
+Expression::Expression()
 {
-    for (const auto& child : children) {
-        m_Children.push_back(std::make_shared<Expression>(child));
+    m_Root = addAtom(QString());
+}
+
+Expression::NodeId Expression::addAtom(const QString& literal)
+{
+    auto it = m_LiteralIds.constFind(literal);
+    if (it == m_LiteralIds.cend()) {
+        it = m_LiteralIds.insert(literal, static_cast<qint32>(m_Literals.size()));
+        m_Literals.push_back(literal);
     }
+
+    m_Nodes.push_back({ Operator::NIL, it.value(), NoNode, NoNode });
+    return static_cast<NodeId>(m_Nodes.size() - 1);
 }
 
-void Expression::setOperator(Operator op)
+Expression::NodeId Expression::addNode(Operator op, NodeId lhs, NodeId rhs)
 {
-    m_Operator = op;
+    m_Nodes.push_back({ op, -1, lhs, rhs });
+    return static_cast<NodeId>(m_Nodes.size() - 1);
 }
 
-void Expression::addOperand(const Expression& expr)
+Expression::NodeId Expression::root() const
 {
-    m_Children.push_back(std::make_shared<Expression>(expr));
+    return m_Root;
 }
 
-void Expression::addOperands(const QList<Expression>& expressions)
+void Expression::setRoot(NodeId node)
 {
-    for (const Expression& expr : expressions) {
-        m_Children.push_back(std::make_shared<Expression>(expr));
-    }
+    m_Root = node;
+}
+
+Operator Expression::op(NodeId node) const
+{
+    return m_Nodes.at(node).op;
+}
+
+Expression::NodeId Expression::lhs(NodeId node) const
+{
+    return m_Nodes.at(node).lhs;
+}
+
+Expression::NodeId Expression::rhs(NodeId node) const
+{
+    return m_Nodes.at(node).rhs;
+}
+
+Expression::NodeId Expression::scope(NodeId node) const
+{
+    return m_Nodes.at(node).lhs;
 }
 
-const Expression& Expression::lhs() const
+qint32 Expression::literalId(NodeId node) const
 {
-    return *m_Children.at(0);
+    return m_Nodes.at(node).literal;
 }
 
-const Expression& Expression::rhs() const
+const QString& Expression::literal(NodeId node) const
 {
-    return *m_Children.at(1);
+    return m_Literals.at(m_Nodes.at(node).literal);
 }
 
-const Expression& Expression::scope() const
+const QStringList& Expression::literals() const
 {
-    return *m_Children.at(0);
+    return m_Literals;
 }
 
-const QString& Expression::literal() const
+qsizetype Expression::size() const
 {
-    return m_Literal;
+    return m_Nodes.size();
 }
 
-Operator Expression::op() const
+void Expression::reserve(qsizetype nodeCount)
 {
-    return m_Operator;
+    m_Nodes.reserve(nodeCount);
 }
 
 void Expression::clear()
 {
-    m_Operator = Operator::NIL;
-    m_Literal.clear();
-    m_Children.clear();
+    m_Nodes.clear();
+    m_Literals.clear();
+    m_LiteralIds.clear();
+    m_Root = NoNode;
 }
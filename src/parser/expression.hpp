@@ -1,33 +1,66 @@
 #pragma once
 
-#include <memory>
-
+#include <QHash>
 #include <QList>
 #include <QString>
+#include <QStringList>
 
 enum class Operator : uint8_t { NOT, AND, OR, NIL };
 
-struct Conjunction;
-struct Disjunction;
-struct Negation;
-
+/**
+ * @brief Arena holding the nodes of a boolean query.
+ *
+ * Nodes live in one flat list and refer to their operands by index, so building
+ * and transforming a query never copies subtrees: a transformation appends the
+ * nodes it creates and reuses the ids of the ones it leaves unchanged. Literals
+ * are interned, and every node of an atom refers to its literal by id.
+ *
+ * An expression is move-only; a default-constructed one holds a single atom
+ * with the empty literal.
+ */
 class Expression
 {
 public:
-    Expression() = default;
-    Expression(Operator op, QString literal = "", const QList<Expression>& = {});
-    void setOperator(Operator op);
-    void addOperand(const Expression& expr);
-    void addOperands(const QList<Expression>& expressions);
-    const Expression& lhs() const;
-    const Expression& rhs() const;
-    const Expression& scope() const;
-    const QString& literal() const;
-    Operator op() const;
+    using NodeId = qint32;
+    static constexpr NodeId NoNode = -1;
+
+    Expression();
+    ~Expression() = default;
+
+    Expression(Expression&&) noexcept = default;
+    Expression& operator=(Expression&&) noexcept = default;
+    Expression(const Expression&) = delete;
+    Expression& operator=(const Expression&) = delete;
+
+    NodeId addAtom(const QString& literal);
+    NodeId addNode(Operator op, NodeId lhs, NodeId rhs = NoNode);
+
+    NodeId root() const;
+    void setRoot(NodeId node);
+
+    Operator op(NodeId node) const;
+    NodeId lhs(NodeId node) const;
+    NodeId rhs(NodeId node) const;
+    NodeId scope(NodeId node) const;
+    qint32 literalId(NodeId node) const;
+    const QString& literal(NodeId node) const;
+
+    const QStringList& literals() const;
+    qsizetype size() const;
+    void reserve(qsizetype nodeCount);
     void clear();
 
 private:
-    Operator m_Operator = Operator::NIL;
-    QString m_Literal = "";
-    QList<std::shared_ptr<Expression>> m_Children = {};
+    struct Node
+    {
+        Operator op;
+        qint32 literal;
+        NodeId lhs;
+        NodeId rhs;
+    };
+
+    QList<Node> m_Nodes;
+    QStringList m_Literals;
+    QHash<QString, qint32> m_LiteralIds;
+    NodeId m_Root = NoNode;
 };
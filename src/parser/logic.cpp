@@ -1,125 +1,157 @@
 #include "logic.hpp"
 
-bool isAtomic(const Expression& expr)
+using NodeId = Expression::NodeId;
+
+bool isAtomic(const Expression& expr, NodeId node)
 {
-    return expr.op() == Operator::NIL;
+    return expr.op(node) == Operator::NIL;
 }
 
-bool isConjunction(const Expression& expr)
+bool isConjunction(const Expression& expr, NodeId node)
 {
-    return expr.op() == Operator::AND;
+    return expr.op(node) == Operator::AND;
 }
 
-bool isDisjunction(const Expression& expr)
+bool isDisjunction(const Expression& expr, NodeId node)
 {
-    return expr.op() == Operator::OR;
+    return expr.op(node) == Operator::OR;
 }
 
-bool isNegation(const Expression& expr)
+bool isNegation(const Expression& expr, NodeId node)
 {
-    return expr.op() == Operator::NOT;
+    return expr.op(node) == Operator::NOT;
 }
 
 namespace {
-    bool noOr(const Expression& expr) {
-        if (isAtomic(expr)) {
+    bool noOr(const Expression& expr, NodeId node) {
+        if (isAtomic(expr, node)) {
             return true;
         }
-        if (isNegation(expr)) {
-            return noOr(expr.scope());
+        if (isNegation(expr, node)) {
+            return noOr(expr, expr.scope(node));
         }
-        if (isDisjunction(expr)) {
+        if (isDisjunction(expr, node)) {
             return false;
         }
-        return noOr(expr.lhs()) && noOr(expr.rhs());
+        return noOr(expr, expr.lhs(node)) && noOr(expr, expr.rhs(node));
     }
 
-    bool noAndAboveOr(const Expression& expr)
+    bool noAndAboveOr(const Expression& expr, NodeId node)
     {
-        if (isAtomic(expr)) {
+        if (isAtomic(expr, node)) {
             return true;
         }
-        if (isNegation(expr)) {
-            return noAndAboveOr(expr.scope());
+        if (isNegation(expr, node)) {
+            return noAndAboveOr(expr, expr.scope(node));
+        }
+        if (isDisjunction(expr, node)) {
+            return noAndAboveOr(expr, expr.lhs(node)) && noAndAboveOr(expr, expr.rhs(node));
+        }
+        return noOr(expr, expr.lhs(node)) && noOr(expr, expr.rhs(node));
+    }
+
+    bool isNNF(const Expression& expr, NodeId node)
+    {
+        if (isAtomic(expr, node)) {
+            return true;
         }
-        if (isDisjunction(expr)) {
-            return noAndAboveOr(expr.lhs()) && noAndAboveOr(expr.rhs());
+        if (isNegation(expr, node)) {
+            return isAtomic(expr, expr.scope(node));
         }
-        return noOr(expr.lhs()) && noOr(expr.rhs());
+        return isNNF(expr, expr.lhs(node)) && isNNF(expr, expr.rhs(node));
     }
 
-    Expression distributeAndOr(const Expression& expr1, const Expression& expr2)
+    // operands are shared by id, so distributing never copies a subtree
+    NodeId distributeAndOr(Expression& expr, NodeId node1, NodeId node2)
     {
-        if (isDisjunction(expr1)) {
-            return Expression(Operator::OR, "", { distributeAndOr(expr1.lhs(), expr2), distributeAndOr(expr1.rhs(), expr2) });
+        if (isDisjunction(expr, node1)) {
+            const NodeId lhs = distributeAndOr(expr, expr.lhs(node1), node2);
+            const NodeId rhs = distributeAndOr(expr, expr.rhs(node1), node2);
+            return expr.addNode(Operator::OR, lhs, rhs);
         }
-        if (isDisjunction(expr2)) {
-            return Expression(Operator::OR, "", { distributeAndOr(expr1, expr2.lhs()), distributeAndOr(expr1, expr2.rhs()) });
+        if (isDisjunction(expr, node2)) {
+            const NodeId lhs = distributeAndOr(expr, node1, expr.lhs(node2));
+            const NodeId rhs = distributeAndOr(expr, node1, expr.rhs(node2));
+            return expr.addNode(Operator::OR, lhs, rhs);
         }
-        return Expression(Operator::AND, "", { expr1, expr2 });
+        return expr.addNode(Operator::AND, node1, node2);
+    }
+
+    NodeId rebuild(Expression& expr, NodeId node, NodeId lhs, NodeId rhs)
+    {
+        if (lhs == expr.lhs(node) && rhs == expr.rhs(node)) {
+            return node;
+        }
+        return expr.addNode(expr.op(node), lhs, rhs);
     }
     } // namespace
 
 bool isDNF(const Expression& expr)
 {
-    return isNNF(expr) && noAndAboveOr(expr);
+    return expr.root() == Expression::NoNode || (isNNF(expr) && noAndAboveOr(expr, expr.root()));
 }
 
 bool isNNF(const Expression& expr)
 {
-    if (isAtomic(expr)) {
-        return true;
-    }
-    if (isNegation(expr)) {
-        return isAtomic(expr.scope());
-    }
-    return isNNF(expr.lhs()) && isNNF(expr.rhs());
+    return expr.root() == Expression::NoNode || isNNF(expr, expr.root());
+}
+
+Expression toDNF(Expression expr)
+{
+    return NNFtoDNF(toNNF(std::move(expr)));
 }
 
-Expression NNFtoDNF(const Expression& expr)
+Expression toNNF(Expression expr)
 {
-    if (isAtomic(expr) || isNegation(expr)) {
-        return expr;
+    if (expr.root() != Expression::NoNode) {
+        expr.setRoot(toNNF(expr, expr.root()));
     }
-    if (isDisjunction(expr)) {
-        return Expression(Operator::OR, "", { toDNF(expr.lhs()), toDNF(expr.rhs()) });
+    return expr;
+}
+
+Expression NNFtoDNF(Expression expr)
+{
+    if (expr.root() != Expression::NoNode) {
+        expr.setRoot(NNFtoDNF(expr, expr.root()));
     }
-    return distributeAndOr(toDNF(expr.lhs()), toDNF(expr.rhs()));
+    return expr;
 }
 
-Expression toDNF(const Expression& expr)
+NodeId NNFtoDNF(Expression& expr, NodeId node)
 {
-    return NNFtoDNF(toNNF(expr));
+    if (isAtomic(expr, node) || isNegation(expr, node)) {
+        return node;
+    }
+    const NodeId lhs = NNFtoDNF(expr, expr.lhs(node));
+    const NodeId rhs = NNFtoDNF(expr, expr.rhs(node));
+    if (isDisjunction(expr, node)) {
+        return rebuild(expr, node, lhs, rhs);
+    }
+    return distributeAndOr(expr, lhs, rhs);
 }
 
-Expression toNNF(const Expression& expr)
+NodeId toNNF(Expression& expr, NodeId node)
 {
-    if (isAtomic(expr)) {
-        return expr;
+    if (isAtomic(expr, node)) {
+        return node;
     }
-    if (isNegation(expr)) {
-        const Expression& scope = expr.scope();
+    if (isNegation(expr, node)) {
+        return negatedNNF(expr, expr.scope(node));
+    }
+    const NodeId lhs = toNNF(expr, expr.lhs(node));
+    const NodeId rhs = toNNF(expr, expr.rhs(node));
+    return rebuild(expr, node, lhs, rhs);
+}
 
-        if (isAtomic(scope)) {
-            return expr;
-        }
-        if (isNegation(scope)) {
-            return toNNF(scope.scope());
-        }
-        if (isDisjunction(scope)) {
-            const Expression lhs = isNegation(toNNF(scope.lhs())) ? toNNF(scope.lhs()).scope() : Expression(Operator::NOT, "", { toNNF(scope.lhs()) });
-            const Expression rhs = isNegation(toNNF(scope.rhs())) ? toNNF(scope.rhs()).scope() : Expression(Operator::NOT, "", { toNNF(scope.rhs()) });
-            return Expression(Operator::AND, "", { lhs, rhs });
-        }
-        if (isConjunction(scope)) {
-            const Expression lhs = isNegation(toNNF(scope.lhs())) ? toNNF(scope.lhs()).scope() : Expression(Operator::NOT, "", { toNNF(scope.lhs()) });
-            const Expression rhs = isNegation(toNNF(scope.rhs())) ? toNNF(scope.rhs()).scope() : Expression(Operator::NOT, "", { toNNF(scope.rhs()) });
-            return Expression(Operator::OR, "", { lhs, rhs });
-        }
-        return {};
+NodeId negatedNNF(Expression& expr, NodeId node)
+{
+    if (isAtomic(expr, node)) {
+        return expr.addNode(Operator::NOT, node);
     }
-    if (isDisjunction(expr)) {
-        return Expression(Operator::OR, "", { toNNF(expr.lhs()), toNNF(expr.rhs()) });
+    if (isNegation(expr, node)) {
+        return toNNF(expr, expr.scope(node));
     }
-    return Expression(Operator::AND, "", { toNNF(expr.lhs()), toNNF(expr.rhs()) });
+    const NodeId lhs = negatedNNF(expr, expr.lhs(node));
+    const NodeId rhs = negatedNNF(expr, expr.rhs(node));
+    return expr.addNode(isDisjunction(expr, node) ? Operator::AND : Operator::OR, lhs, rhs);
 }
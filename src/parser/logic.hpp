@@ -2,15 +2,18 @@
 
 #include "expression.hpp"
 
-bool isNegation(const Expression& expr);
-bool isDisjunction(const Expression& expr);
-bool isConjunction(const Expression& expr);
-bool isAtomic(const Expression& expr);
+bool isNegation(const Expression& expr, Expression::NodeId node);
+bool isDisjunction(const Expression& expr, Expression::NodeId node);
+bool isConjunction(const Expression& expr, Expression::NodeId node);
+bool isAtomic(const Expression& expr, Expression::NodeId node);
 
 bool isNNF(const Expression& expr);
 bool isDNF(const Expression& expr);
 
-Expression toDNF(const Expression& expr);
-Expression toNNF(const Expression& expr);
+Expression toDNF(Expression expr);
+Expression toNNF(Expression expr);
+Expression NNFtoDNF(Expression expr);
 
-Expression NNFtoDNF(const Expression& expr);
+Expression::NodeId toNNF(Expression& expr, Expression::NodeId node);
+Expression::NodeId negatedNNF(Expression& expr, Expression::NodeId node);
+Expression::NodeId NNFtoDNF(Expression& expr, Expression::NodeId node);
@@ -15,19 +15,21 @@ bool checkQuery(const QString& query)
 }
 
 namespace {
-    QPair<QStringList, QStringList> getQueryLists(const Expression& expression)
+    using NodeId = Expression::NodeId;
+
+    QPair<QStringList, QStringList> getQueryLists(const Expression& expression, NodeId node)
     {
-        if (isAtomic(expression)) {
-            QStringList const inclusions{expression.literal()};
+        if (isAtomic(expression, node)) {
+            QStringList const inclusions{expression.literal(node)};
             return { inclusions, {} };
         }
-        if (isNegation(expression)) {
-            QStringList const exclusions{expression.scope().literal()};
+        if (isNegation(expression, node)) {
+            QStringList const exclusions{expression.literal(expression.scope(node))};
             return { {}, exclusions };
         }
-        if (isConjunction(expression)) {
-            const auto& [lhs_inclusions, lhs_exclusions] = getQueryLists(expression.lhs());
-            const auto& [rhs_inclusions, rhs_exclusions] = getQueryLists(expression.rhs());
+        if (isConjunction(expression, node)) {
+            const auto& [lhs_inclusions, lhs_exclusions] = getQueryLists(expression, expression.lhs(node));
+            const auto& [rhs_inclusions, rhs_exclusions] = getQueryLists(expression, expression.rhs(node));
 
             QStringList inclusions;
             inclusions.reserve(lhs_inclusions.size() + rhs_inclusions.size());
@@ -43,25 +45,28 @@ namespace {
         return {};
     }
 
-    QList<QPair<QStringList, QStringList>> getQueries(const Expression& expression)
+    QList<QPair<QStringList, QStringList>> getQueries(const Expression& expression, NodeId node)
     {
-        if (!isDisjunction(expression)) {
-            return { getQueryLists(expression) };
+        if (!isDisjunction(expression, node)) {
+            return { getQueryLists(expression, node) };
         }
 
-        if (isConjunction(expression.lhs())) {
-            QList<QPair<QStringList, QStringList>> queries = getQueries(expression.rhs());
-            queries.push_back(getQueryLists(expression.lhs()));
+        const NodeId lhs = expression.lhs(node);
+        const NodeId rhs = expression.rhs(node);
+
+        if (isConjunction(expression, lhs)) {
+            QList<QPair<QStringList, QStringList>> queries = getQueries(expression, rhs);
+            queries.push_back(getQueryLists(expression, lhs));
             return queries;
         }
-        if (isConjunction(expression.rhs())) {
-            QList<QPair<QStringList, QStringList>> queries = getQueries(expression.lhs());
-            queries.push_back(getQueryLists(expression.rhs()));
+        if (isConjunction(expression, rhs)) {
+            QList<QPair<QStringList, QStringList>> queries = getQueries(expression, lhs);
+            queries.push_back(getQueryLists(expression, rhs));
             return queries;
         }
 
-        QList<QPair<QStringList, QStringList>> lhs_queries = getQueries(expression.lhs());
-        QList<QPair<QStringList, QStringList>> rhs_queries = getQueries(expression.rhs());
+        QList<QPair<QStringList, QStringList>> lhs_queries = getQueries(expression, lhs);
+        QList<QPair<QStringList, QStringList>> rhs_queries = getQueries(expression, rhs);
         QList<QPair<QStringList, QStringList>> queries;
         std::ranges::merge(lhs_queries, rhs_queries, std::back_inserter(queries));
         return queries;
@@ -75,6 +80,24 @@ QList<QPair<QStringList, QStringList>> getQueries(const QString& queryStr)
     }
 
     Expression expr;
-    BooleanParser().parse(queryStr, expr);
-    return getQueries(toDNF(expr));
+    if (!BooleanParser().parse(queryStr, expr)) {
+        return {};
+    }
+    const Expression dnf = toDNF(std::move(expr));
+    return getQueries(dnf, dnf.root());
+}
+
+Expression getQueryExpression(const QString& queryStr)
+{
+    // the empty literal is contained in every prompt, like the empty query of getQueries()
+    if (queryStr.isEmpty()) {
+        return {};
+    }
+
+    // an unparsable query is left without a root and matches nothing; CompiledQuery converts the rest to NNF
+    Expression expr;
+    if (!BooleanParser().parse(queryStr, expr)) {
+        expr.clear();
+    }
+    return expr;
 }
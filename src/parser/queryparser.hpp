@@ -5,5 +5,8 @@
 #include <QString>
 #include <QStringList>
 
+#include "expression.hpp"
+
 bool checkQuery(const QString& queryStr);
 QList<QPair<QStringList, QStringList>> getQueries(const QString& queryStr);
+Expression getQueryExpression(const QString& queryStr);
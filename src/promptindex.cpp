@@ -0,0 +1,279 @@
+#include "promptindex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "logic.hpp"
+
+namespace {
+    constexpr quint32 indexMagic = 0x48504249; // "HPBI"
+    constexpr quint32 indexVersion = 1;
+
+    QList<quint32> intersect(const QList<quint32>& lhs, const QList<quint32>& rhs)
+    {
+        QList<quint32> result;
+        std::set_intersection(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(), std::back_inserter(result));
+        return result;
+    }
+
+    QList<quint32> unite(const QList<quint32>& lhs, const QList<quint32>& rhs)
+    {
+        QList<quint32> result;
+        result.reserve(lhs.size() + rhs.size());
+        std::set_union(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(), std::back_inserter(result));
+        return result;
+    }
+} // namespace
+
+/***************
+ * PromptIndex *
+ ***************/
+
+PromptIndex::PromptIndex(const QString& indexFile, const QString& instancesFile)
+    : m_File(indexFile), m_InstancesFile(instancesFile)
+{}
+
+PromptIndex::~PromptIndex()
+{
+    if (m_Data != nullptr) {
+        m_File.unmap(m_Data);
+    }
+}
+
+/**
+ * @brief Maps the index file and checks it against its source.
+ *
+ * @return bool True if the index exists, is well-formed and is up to date.
+ */
+bool PromptIndex::open()
+{
+    if (!m_File.exists() || !m_File.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = m_File.size();
+    if (fileSize < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    // the index is only an accelerator, so there is no in-memory fallback when mapping fails
+    m_Data = m_File.map(0, fileSize);
+    if (m_Data == nullptr) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, m_Data, sizeof(Header));
+    if (header.magic != indexMagic || header.version != indexVersion) {
+        return false;
+    }
+
+    const QFileInfo source(m_InstancesFile);
+    if (!source.exists() || source.size() != header.sourceSize || source.lastModified().toMSecsSinceEpoch() != header.sourceMtime) {
+        return false;
+    }
+
+    const qint64 tablesSize = qint64(sizeof(Header)) + qint64(header.keyCount) * 8 + (qint64(header.keyCount) + 1) * 4;
+    if (fileSize < tablesSize) {
+        return false;
+    }
+
+    m_KeyCount = header.keyCount;
+    m_Keys = reinterpret_cast<const quint64*>(m_Data + sizeof(Header));
+    m_Offsets = reinterpret_cast<const quint32*>(m_Keys + m_KeyCount);
+    m_Postings = m_Offsets + m_KeyCount + 1;
+
+    return fileSize >= tablesSize + qint64(m_Offsets[m_KeyCount]) * 4;
+}
+
+/**
+ * @brief Narrows a query down to the instances that may match it.
+ *
+ * Conjunctions intersect and disjunctions unite the candidates of their
+ * operands. Negated terms are not subtracted: an instance containing all
+ * trigrams of an excluded term does not necessarily contain the term itself.
+ *
+ * @param query The query in negation normal form.
+ * @return std::optional<QList<quint32>> Ascending instance indices, or nothing if the query cannot be narrowed down.
+ */
+std::optional<QList<quint32>> PromptIndex::candidates(const Expression& query) const
+{
+    if (query.root() == Expression::NoNode) {
+        return QList<quint32>();
+    }
+    return candidates(query, query.root());
+}
+
+std::optional<QList<quint32>> PromptIndex::candidates(const Expression& query, const Expression::NodeId node) const
+{
+    if (isAtomic(query, node)) {
+        return termCandidates(query.literal(node));
+    }
+    if (isNegation(query, node)) {
+        return std::nullopt;
+    }
+
+    std::optional<QList<quint32>> lhs = candidates(query, query.lhs(node));
+    if (isConjunction(query, node)) {
+        if (lhs && lhs->isEmpty()) {
+            return lhs;
+        }
+        std::optional<QList<quint32>> rhs = candidates(query, query.rhs(node));
+        if (!lhs || !rhs) {
+            return lhs ? lhs : rhs;
+        }
+        return intersect(*lhs, *rhs);
+    }
+
+    if (!lhs) {
+        return std::nullopt;
+    }
+    const std::optional<QList<quint32>> rhs = candidates(query, query.rhs(node));
+    if (!rhs) {
+        return std::nullopt;
+    }
+    return unite(*lhs, *rhs);
+}
+
+/**
+ * @brief Computes the index file kept next to an instance cache file.
+ *
+ * @param cacheFile Path of the task's instance cache.
+ * @return QString Path of the task's full-text index.
+ */
+QString PromptIndex::indexFileFor(const QString& cacheFile)
+{
+    const QFileInfo cache(cacheFile);
+    return cache.path() + "/" + cache.completeBaseName() + ".hpbi";
+}
+
+/**
+ * @brief Extracts the case-folded trigrams of a text.
+ *
+ * @param text The text to be indexed or looked up.
+ * @return QList<quint64> The distinct trigram keys, ascending.
+ */
+QList<quint64> PromptIndex::trigrams(const QString& text)
+{
+    QList<quint64> keys;
+    if (text.size() < 3) {
+        return keys;
+    }
+
+    keys.reserve(text.size() - 2);
+    quint64 window = 0;
+    for (const qsizetype i : std::views::iota(qsizetype(0), text.size())) {
+        window = ((window << 16) | text.at(i).toCaseFolded().unicode()) & 0xFFFFFFFFFFFFull;
+        if (i >= 2) {
+            keys.push_back(window);
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+/**
+ * @brief Looks up the instances containing all trigrams of a term.
+ *
+ * @param term A plain-text search term.
+ * @return std::optional<QList<quint32>> Ascending instance indices, or nothing if the term is too short to be looked up.
+ */
+std::optional<QList<quint32>> PromptIndex::termCandidates(const QString& term) const
+{
+    // case folding of characters outside the BMP spans two code units and is not indexed faithfully
+    if (std::ranges::any_of(term, [](const QChar c) { return c.isSurrogate(); })) {
+        return std::nullopt;
+    }
+
+    const QList<quint64> keys = trigrams(term);
+    if (keys.isEmpty()) {
+        return std::nullopt;
+    }
+
+    QList<QPair<quint32, quint32>> ranges;
+    for (const quint64 key : keys) {
+        const quint64* found = std::lower_bound(m_Keys, m_Keys + m_KeyCount, key);
+        if (found == m_Keys + m_KeyCount || *found != key) {
+            return QList<quint32>();
+        }
+        const qsizetype k = found - m_Keys;
+        ranges.push_back({ m_Offsets[k], m_Offsets[k + 1] });
+    }
+
+    // intersect the shortest lists first
+    std::sort(ranges.begin(), ranges.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second - lhs.first < rhs.second - rhs.first;
+    });
+
+    QList<quint32> result(m_Postings + ranges.first().first, m_Postings + ranges.first().second);
+    for (const auto& [begin, end] : ranges | std::views::drop(1)) {
+        QList<quint32> narrowed;
+        std::set_intersection(result.cbegin(), result.cend(), m_Postings + begin, m_Postings + end, std::back_inserter(narrowed));
+        result = std::move(narrowed);
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*********************
+ * PromptIndexWriter *
+ *********************/
+
+PromptIndexWriter::PromptIndexWriter(const QString& indexFile, const QString& instancesFile)
+    : m_IndexFile(indexFile)
+{
+    // taken before reading, so a source modified meanwhile invalidates the index
+    const QFileInfo source(instancesFile);
+    m_SourceSize = source.size();
+    m_SourceMtime = source.lastModified().toMSecsSinceEpoch();
+}
+
+void PromptIndexWriter::append(const TaskInstance& instance)
+{
+    for (const quint64 key : PromptIndex::trigrams(instance.input)) {
+        m_Postings[key].push_back(m_Count);
+    }
+    ++m_Count;
+}
+
+bool PromptIndexWriter::commit()
+{
+    QList<quint64> keys = m_Postings.keys();
+    std::sort(keys.begin(), keys.end());
+
+    QList<quint32> offsets;
+    offsets.reserve(keys.size() + 1);
+    quint32 postingCount = 0;
+    for (const quint64 key : std::as_const(keys)) {
+        offsets.push_back(postingCount);
+        postingCount += m_Postings.value(key).size();
+    }
+    offsets.push_back(postingCount);
+
+    const PromptIndex::Header header = { indexMagic, indexVersion, m_SourceSize, m_SourceMtime, m_Count, static_cast<quint32>(keys.size()) };
+
+    QSaveFile file(m_IndexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(keys.constData()), keys.size() * sizeof(quint64));
+    file.write(reinterpret_cast<const char*>(offsets.constData()), offsets.size() * sizeof(quint32));
+    for (const quint64 key : std::as_const(keys)) {
+        const QList<quint32>& postings = m_Postings[key];
+        file.write(reinterpret_cast<const char*>(postings.constData()), postings.size() * sizeof(quint32));
+    }
+
+    return file.commit();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <optional>
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include "expression.hpp"
+#include "taskinstance.hpp"
+
+/*
+ * Full-text index file layout (native byte order, read through a memory map):
+ *
+ *   Header   magic ("HPBI"), format version, size and modification time of the
+ *            source instances.json, instance count, trigram count
+ *   quint64  trigram keys, ascending
+ *   quint32  start of each key's posting list, plus one past the last list
+ *   quint32  posting lists: ascending instance indices into the task's cache
+ *
+ * Keys are three consecutive case-folded UTF-16 code units of a prompt's input.
+ */
+
+/**
+ * @brief Read-only trigram index over the inputs of one task's instances.
+ *
+ * Substring search cannot be answered exactly from trigrams, so the index only
+ * narrows a query down to the instances that may match; every candidate still
+ * has to be verified with matches().
+ */
+class PromptIndex
+{
+public:
+    PromptIndex(const QString& indexFile, const QString& instancesFile);
+    ~PromptIndex();
+
+    PromptIndex(const PromptIndex&) = delete;
+    PromptIndex& operator=(const PromptIndex&) = delete;
+
+    bool open();
+    std::optional<QList<quint32>> candidates(const Expression& query) const;
+
+    static QString indexFileFor(const QString& cacheFile);
+    static QList<quint64> trigrams(const QString& text);
+
+private:
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        qint64 sourceSize;
+        qint64 sourceMtime;
+        quint32 instanceCount;
+        quint32 keyCount;
+    };
+
+    std::optional<QList<quint32>> candidates(const Expression& query, Expression::NodeId node) const;
+    std::optional<QList<quint32>> termCandidates(const QString& term) const;
+
+    QFile m_File;
+    QString m_InstancesFile;
+    uchar* m_Data = nullptr;
+    const quint64* m_Keys = nullptr;
+    const quint32* m_Offsets = nullptr;
+    const quint32* m_Postings = nullptr;
+    quint32 m_KeyCount = 0;
+
+    friend class PromptIndexWriter;
+};
+
+/**
+ * @brief Collects the trigrams of instances in cache order and writes a PromptIndex file.
+ */
+class PromptIndexWriter
+{
+public:
+    PromptIndexWriter(const QString& indexFile, const QString& instancesFile);
+
+    void append(const TaskInstance& instance);
+    bool commit();
+
+private:
+    QString m_IndexFile;
+    qint64 m_SourceSize = 0;
+    qint64 m_SourceMtime = 0;
+    quint32 m_Count = 0;
+    QHash<quint64, QList<quint32>> m_Postings;
+};
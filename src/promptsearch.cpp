@@ -0,0 +1,398 @@
+#include "promptsearch.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "helperfunctions.hpp"
+#include "instancecache.hpp"
+#include "instancereader.hpp"
+#include "promptindex.hpp"
+#include "prompttextcache.hpp"
+#include "trace.hpp"
+
+namespace {
+    /**
+     * @brief Opens a task's cached instances, narrowed down to the index candidates of a query.
+     *
+     * @param taskDir The HELM run directory holding the dataset's instances.
+     * @param helmDataPath The base path for Helm data.
+     * @param cachePath The directory holding instance caches.
+     * @param query The compiled plain-text query.
+     * @return std::unique_ptr<InstanceReader> The reader, or nullptr if the task has no up-to-date cache and index.
+     */
+    std::unique_ptr<InstanceReader> openIndexedInstances(const QString& taskDir,
+                                                         const QString& helmDataPath,
+                                                         const QString& cachePath,
+                                                         const CompiledQuery& query)
+    {
+        if (cachePath.isEmpty()) {
+            return nullptr;
+        }
+
+        const QString instancesFile = helmDataPath + "/" + taskDir + "/instances.json";
+        const QString cacheFile = InstanceCache::cacheFileFor(cachePath, instancesFile);
+
+        PromptIndex index(PromptIndex::indexFileFor(cacheFile), instancesFile);
+        auto cached = std::make_unique<CachedInstanceReader>(cacheFile, instancesFile);
+        if (!index.open() || !cached->open()) {
+            return nullptr;
+        }
+
+        if (const std::optional<QList<quint32>> candidates = index.candidates(query.expression())) {
+            cached->restrictTo(*candidates);
+        }
+        return cached;
+    }
+
+    /**
+     * @brief Checks if a task has an up-to-date binary cache, from which any of its instances is read without the ones before it.
+     */
+    bool hasInstanceCache(const PromptStore::Task& task, const QString& cachePath)
+    {
+        if (cachePath.isEmpty()) {
+            return false;
+        }
+        const QString instancesFile = task.helmDataPath + "/" + task.taskDir + "/instances.json";
+        return CachedInstanceReader(InstanceCache::cacheFileFor(cachePath, instancesFile), instancesFile).open();
+    }
+
+    /**
+     * @brief A slice of a filter snapshot: prompts of one task, and where they start in the snapshot.
+     */
+    struct FilterChunk {
+        qsizetype offset = 0;
+        TaskPrompts prompts;
+    };
+} // namespace
+
+/**
+ * @brief Loads a dataset's instances and keeps those matching the query.
+ *
+ * This is the part of a search that runs on a worker thread; the caller merges
+ * the result into the prompt tree.
+ *
+ * @param dataset The dataset name.
+ * @param taskDir The HELM run directory holding the dataset's instances.
+ * @param helmDataPath The base path for Helm data.
+ * @param cachePath The directory holding instance caches; empty to disable caching.
+ * @param query The compiled search query.
+ * @param useFullTextIndex If true, only the index candidates of the query are read, and missing indexes are built.
+ * @param ids If not null, the instances with these ids are kept instead of those matching the query.
+ * @param progress Optional counters; receives the number of bytes processed and is polled for cancellation.
+ * @return DatasetMatches The matching prompts, or an error message.
+ */
+DatasetMatches searchDataset(const QString& dataset,
+                             const QString& taskDir,
+                             const QString& helmDataPath,
+                             const QString& cachePath,
+                             const CompiledQuery& query,
+                             const bool useFullTextIndex,
+                             const QSet<QString>* ids,
+                             JobProgress* progress)
+{
+    const TraceSpan span("searchDataset", dataset);
+
+    DatasetMatches result;
+    result.task = { dataset, helmDataPath, taskDir };
+
+    if (progress != nullptr && progress->cancelled.load(std::memory_order_relaxed)) {
+        return result;
+    }
+
+    std::unique_ptr<InstanceReader> instances;
+    if (ids == nullptr && useFullTextIndex && !query.isRegex()) {
+        instances = openIndexedInstances(taskDir, helmDataPath, cachePath, query);
+    }
+    if (!instances) {
+        instances = getTaskInstances(taskDir, helmDataPath, cachePath, useFullTextIndex);
+    }
+    if (!instances) {
+        result.error = "Failed to open instances.json from " + taskDir;
+        if (progress != nullptr) {
+            progress->done.fetch_add(QFileInfo(helmDataPath + "/" + taskDir + "/instances.json").size(), std::memory_order_relaxed);
+            progress->datasetsDone.fetch_add(1, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    result.prompts = getNewPrompts(ids != nullptr ? findInstancesById(*instances, *ids, progress)
+                                                  : findMatchingInstances(*instances, query, progress));
+
+    if (!instances->errorString().isEmpty()) {
+        result.error = "Error reading instances.json from " + taskDir + ":\n" + instances->errorString();
+    }
+
+    if (progress != nullptr) {
+        // account for whatever trailed the last instance (closing bracket, or the rest of a malformed file)
+        progress->done.fetch_add(instances->size() - instances->position(), std::memory_order_relaxed);
+        progress->datasetsDone.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+/*****************
+ * BackgroundJob *
+ *****************/
+
+BackgroundJob::BackgroundJob(QThreadPool* pool, QObject* parent)
+    : QObject(parent)
+    , m_Pool(pool)
+    , m_Progress(std::make_shared<JobProgress>())
+{
+    const int progressInterval = 100;
+    m_Timer.setInterval(progressInterval);
+    connect(&m_Timer, &QTimer::timeout, this, &BackgroundJob::reportProgress);
+}
+
+BackgroundJob::~BackgroundJob()
+{
+    // workers only hold the shared counters and their own copies of the inputs,
+    // so they may outlive the job; just make them stop early
+    m_Progress->cancelled = true;
+}
+
+bool BackgroundJob::isRunning() const
+{
+    return m_Running;
+}
+
+/**
+ * @brief Estimates the remaining time by extrapolating the throughput observed so far.
+ *
+ * @return qint64 Milliseconds left, or -1 while no estimate is available.
+ */
+qint64 BackgroundJob::remainingMsecs() const
+{
+    const qint64 done = m_Progress->done.load(std::memory_order_relaxed);
+    if (!m_Running || done <= 0 || m_Total <= 0) {
+        return -1;
+    }
+    return m_Clock.elapsed() * (m_Total - done) / done;
+}
+
+void BackgroundJob::cancel()
+{
+    m_Progress->cancelled = true;
+}
+
+void BackgroundJob::begin(const qint64 total)
+{
+    m_Progress = std::make_shared<JobProgress>();
+    m_Total = total;
+    m_Running = true;
+    m_Clock.start();
+    m_Timer.start();
+    emit progressChanged(0, m_Total);
+}
+
+void BackgroundJob::end()
+{
+    m_Timer.stop();
+    reportProgress();
+    m_Running = false;
+    emit finished(m_Progress->cancelled.load());
+}
+
+void BackgroundJob::reportProgress()
+{
+    emit progressChanged(std::min(m_Progress->done.load(std::memory_order_relaxed), m_Total), m_Total);
+}
+
+/*************
+ * SearchJob *
+ *************/
+
+SearchJob::SearchJob(QThreadPool* pool, QObject* parent)
+    : BackgroundJob(pool, parent)
+{
+    connect(&m_Watcher, &QFutureWatcher<DatasetMatches>::resultReadyAt, this, &SearchJob::onResultReadyAt);
+    connect(&m_Watcher, &QFutureWatcher<DatasetMatches>::finished, this, &SearchJob::onFinished);
+}
+
+/**
+ * @brief Starts loading and matching the given datasets.
+ *
+ * @param datasets The dataset names.
+ * @param taskDirs The HELM run directory of each dataset, in the same order.
+ * @param helmDataPath The base path for Helm data.
+ * @param cachePath The directory holding instance caches; empty to disable caching.
+ * @param query The compiled search query.
+ * @param useFullTextIndex If true, datasets are narrowed down through their full-text index.
+ * @param idsByDataset Instance ids to keep per dataset name; listed datasets ignore the query.
+ */
+void SearchJob::start(const QStringList& datasets,
+                      const QStringList& taskDirs,
+                      const QString& helmDataPath,
+                      const QString& cachePath,
+                      const CompiledQuery& query,
+                      const bool useFullTextIndex,
+                      const QHash<QString, QSet<QString>>& idsByDataset)
+{
+    Q_ASSERT(!isRunning());
+
+    qint64 totalBytes = 0;
+    for (const QString& taskDir : taskDirs) {
+        totalBytes += QFileInfo(helmDataPath + "/" + taskDir + "/instances.json").size();
+    }
+
+    m_Pending.clear();
+    m_NextResult = 0;
+    m_DatasetCount = static_cast<int>(datasets.size());
+    begin(totalBytes);
+
+    QList<qsizetype> indices(datasets.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::shared_ptr<JobProgress> progress = m_Progress;
+    m_Watcher.setFuture(QtConcurrent::mapped(m_Pool, std::move(indices), [=](qsizetype j) {
+        const auto ids = idsByDataset.constFind(datasets.at(j));
+        return searchDataset(datasets.at(j), taskDirs.at(j), helmDataPath, cachePath, query, useFullTextIndex,
+                             ids != idsByDataset.cend() ? &ids.value() : nullptr, progress.get());
+    }));
+}
+
+int SearchJob::datasetCount() const
+{
+    return m_DatasetCount;
+}
+
+int SearchJob::datasetsDone() const
+{
+    return m_Progress->datasetsDone.load(std::memory_order_relaxed);
+}
+
+void SearchJob::onResultReadyAt(int index)
+{
+    m_Pending.insert(index, m_Watcher.resultAt(index));
+
+    // datasets that became deliverable together are added to the tree as one batch
+    QList<DatasetMatches> ready;
+    while (m_Pending.contains(m_NextResult)) {
+        ready.push_back(m_Pending.take(m_NextResult));
+        ++m_NextResult;
+    }
+    if (!ready.isEmpty()) {
+        emit datasetsReady(ready);
+    }
+}
+
+void SearchJob::onFinished()
+{
+    // after a cancellation there may be gaps; deliver what was completed, still in order
+    if (!m_Pending.isEmpty()) {
+        emit datasetsReady(m_Pending.values());
+    }
+    m_Pending.clear();
+
+    end();
+}
+
+/*************
+ * FilterJob *
+ *************/
+
+FilterJob::FilterJob(QThreadPool* pool, QObject* parent)
+    : BackgroundJob(pool, parent)
+{
+    connect(&m_Watcher, &QFutureWatcher<FilterMatches>::finished, this, &FilterJob::onFinished);
+}
+
+/**
+ * @brief Starts matching the given prompts against the query.
+ *
+ * @param tasks Snapshot of the prompts to evaluate, grouped by task.
+ * @param cachePath The directory holding instance caches; empty to disable caching.
+ * @param query The compiled filter query.
+ */
+void FilterJob::start(const QList<TaskPrompts>& tasks,
+                      const QString& cachePath,
+                      const CompiledQuery& query)
+{
+    Q_ASSERT(!isRunning());
+
+    // large tasks are split, so that filtering a few big datasets still keeps every worker busy; tasks
+    // without a cache are not, since every chunk would parse instances.json from its start
+    const qsizetype maxChunkSize = 4096;
+    QList<FilterChunk> chunks;
+    m_Prompts.clear();
+    for (const TaskPrompts& task : tasks) {
+        const qsizetype chunkSize = hasInstanceCache(task.task, cachePath) ? maxChunkSize : task.prompts.size();
+        for (qsizetype first = 0; first < task.prompts.size(); first += chunkSize) {
+            const qsizetype count = std::min(chunkSize, task.prompts.size() - first);
+            chunks.push_back({ m_Prompts.size(), { task.task, task.instances.sliced(first, count), task.prompts.sliced(first, count), task.ids.sliced(first, count) } });
+            m_Prompts += chunks.constLast().prompts.prompts;
+        }
+    }
+
+    m_Matching.clear();
+    m_Errors.clear();
+    begin(m_Prompts.size());
+
+    std::shared_ptr<JobProgress> progress = m_Progress;
+    m_Watcher.setFuture(QtConcurrent::mapped(m_Pool, std::move(chunks), [=](const FilterChunk& chunk) {
+        FilterMatches result { chunk.offset, QBitArray(chunk.prompts.prompts.size()), QString() };
+        if (progress->cancelled.load(std::memory_order_relaxed)) {
+            return result;
+        }
+        const TraceSpan span("filterChunk", chunk.prompts.task.dataset);
+        const LoadedPromptTexts texts = loadPromptTexts(chunk.prompts, cachePath);
+        result.error = texts.error;
+        for (qsizetype i : _range(qsizetype(0), texts.texts.size())) {
+            if (progress->cancelled.load(std::memory_order_relaxed)) {
+                break;
+            }
+            // a prompt that was not read is kept rather than matched against an empty text
+            if (texts.loaded.testBit(i) && matches(texts.texts.at(i), query)) {
+                result.matching.setBit(i);
+            }
+            progress->done.fetch_add(1, std::memory_order_relaxed);
+        }
+        return result;
+    }));
+}
+
+const QList<PromptStore::PromptId>& FilterJob::matchingPrompts() const
+{
+    return m_Matching;
+}
+
+/**
+ * @brief The errors of the last run, one per task whose prompts could not all be read.
+ */
+const QStringList& FilterJob::errors() const
+{
+    return m_Errors;
+}
+
+void FilterJob::onFinished()
+{
+    if (!m_Progress->cancelled.load()) {
+        // merge the chunk bitsets, so that the matches come out in snapshot order
+        QBitArray matching(m_Prompts.size());
+        for (const FilterMatches& chunk : m_Watcher.future().results()) {
+            if (!chunk.error.isEmpty()) {
+                m_Errors.push_back(chunk.error);
+            }
+            for (qsizetype i : _range(qsizetype(0), chunk.matching.size())) {
+                if (chunk.matching.testBit(i)) {
+                    matching.setBit(chunk.offset + i);
+                }
+            }
+        }
+        // the chunks of a task report the same error
+        m_Errors.removeDuplicates();
+        m_Matching.reserve(matching.count(true));
+        for (qsizetype i : _range(qsizetype(0), m_Prompts.size())) {
+            if (matching.testBit(i)) {
+                m_Matching.push_back(m_Prompts.at(i));
+            }
+        }
+    }
+    m_Prompts.clear();
+    end();
+}
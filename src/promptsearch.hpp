@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "compiledquery.hpp"
+#include "promptstore.hpp"
+#include "prompttextcache.hpp"
+#include "prompttreemodel.hpp"
+#include "taskinstance.hpp"
+
+/**
+ * @brief Result of loading and matching one dataset on a worker thread.
+ *
+ * The prompts are ready to be added to the prompt tree; their texts are
+ * formatted from the task on demand.
+ */
+struct DatasetMatches {
+    PromptStore::Task task;
+    QList<PromptTreeModel::NewPrompt> prompts;
+    QString error;
+};
+
+/**
+ * @brief Counters shared between a background job and its worker tasks.
+ *
+ * Workers poll `cancelled` once per instance, which bounds cancellation latency
+ * to the time it takes to parse and match a single instance.
+ */
+struct JobProgress {
+    std::atomic<bool> cancelled = false;
+    std::atomic<qint64> done = 0;
+    std::atomic<int> datasetsDone = 0;
+};
+
+DatasetMatches searchDataset(const QString& dataset,
+                             const QString& taskDir,
+                             const QString& helmDataPath,
+                             const QString& cachePath,
+                             const CompiledQuery& query,
+                             bool useFullTextIndex,
+                             const QSet<QString>* ids = nullptr,
+                             JobProgress* progress = nullptr);
+
+/**
+ * @brief Common progress, ETA and cancellation handling for jobs run on a thread pool.
+ */
+class BackgroundJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundJob(QThreadPool* pool, QObject* parent = nullptr);
+    ~BackgroundJob() override;
+
+    bool isRunning() const;
+    qint64 remainingMsecs() const;
+
+public slots:
+    void cancel();
+
+signals:
+    void progressChanged(qint64 done, qint64 total);
+    void finished(bool cancelled);
+
+protected:
+    void begin(qint64 total);
+    void end();
+
+    QThreadPool* m_Pool;
+    std::shared_ptr<JobProgress> m_Progress;
+
+private:
+    void reportProgress();
+
+    QTimer m_Timer;
+    QElapsedTimer m_Clock;
+    qint64 m_Total = 0;
+    bool m_Running = false;
+};
+
+/**
+ * @brief Loads and matches datasets concurrently, one pool task per dataset.
+ *
+ * Results are emitted on the thread owning the job, in dataset order, as soon as
+ * every preceding dataset has been delivered. Progress is measured in bytes of
+ * `instances.json` processed. Datasets can be restricted to given instance ids,
+ * e.g. those of an imported compilation, instead of being matched against the query.
+ */
+class SearchJob : public BackgroundJob
+{
+    Q_OBJECT
+
+public:
+    explicit SearchJob(QThreadPool* pool, QObject* parent = nullptr);
+
+    void start(const QStringList& datasets,
+               const QStringList& taskDirs,
+               const QString& helmDataPath,
+               const QString& cachePath,
+               const CompiledQuery& query,
+               bool useFullTextIndex,
+               const QHash<QString, QSet<QString>>& idsByDataset = {});
+
+    int datasetCount() const;
+    int datasetsDone() const;
+
+signals:
+    void datasetsReady(const QList<DatasetMatches>& matches);
+
+private:
+    void onResultReadyAt(int index);
+    void onFinished();
+
+    QFutureWatcher<DatasetMatches> m_Watcher;
+    QMap<int, DatasetMatches> m_Pending;
+    int m_NextResult = 0;
+    int m_DatasetCount = 0;
+};
+
+/**
+ * @brief The prompts of a chunk of a filter snapshot that match the query.
+ */
+struct FilterMatches {
+    qsizetype offset = 0;   // position of the chunk's first prompt in the snapshot
+    QBitArray matching;
+    QString error;
+};
+
+/**
+ * @brief Matches a snapshot of prompts against a query on the thread pool.
+ *
+ * The snapshot is split into chunks of prompts of the same HELM task, whose
+ * texts are formatted from their instances by the workers; a task without an
+ * up-to-date binary cache is a single chunk, read in one pass. Each chunk yields a
+ * bitset of its matching prompts. Prompts whose instance cannot be read are
+ * neither matched nor removed, and reported as errors. Progress is measured in
+ * prompts evaluated. A cancelled job reports no matches.
+ */
+class FilterJob : public BackgroundJob
+{
+    Q_OBJECT
+
+public:
+    explicit FilterJob(QThreadPool* pool, QObject* parent = nullptr);
+
+    void start(const QList<TaskPrompts>& tasks,
+               const QString& cachePath,
+               const CompiledQuery& query);
+
+    const QList<PromptStore::PromptId>& matchingPrompts() const;
+    const QStringList& errors() const;
+
+private:
+    void onFinished();
+
+    QFutureWatcher<FilterMatches> m_Watcher;
+    QList<PromptStore::PromptId> m_Prompts;
+    QList<PromptStore::PromptId> m_Matching;
+    QStringList m_Errors;
+};
@@ -0,0 +1,538 @@
+#include "promptstore.hpp"
+
+#include <algorithm>
+
+namespace {
+    // grows geometrically, so reserving before every batch keeps appends amortized O(1)
+    template<typename Container>
+    void reserveFor(Container& container, const qsizetype size)
+    {
+        if (container.capacity() < size) {
+            container.reserve(std::max(size, 2 * container.capacity()));
+        }
+    }
+} // namespace
+
+/**
+ * @brief Appends a dataset base.
+ *
+ * @param name The dataset base name.
+ * @return BaseId The id of the new base.
+ */
+PromptStore::BaseId PromptStore::addBase(const QString& name)
+{
+    const auto base = static_cast<BaseId>(m_Bases.size());
+    m_Bases.push_back({ name });
+    m_BasesByName.insert(name, base);
+    return base;
+}
+
+/**
+ * @brief Appends a (sub)dataset group to a base.
+ *
+ * A group with an empty spec holds the prompts of a dataset without
+ * specifications; they are shown directly under the base.
+ *
+ * @param base The base the group belongs to.
+ * @param spec The dataset specification, or an empty string.
+ * @return GroupId The id of the new group.
+ */
+PromptStore::GroupId PromptStore::addGroup(const BaseId base, const QString& spec)
+{
+    const auto group = static_cast<GroupId>(m_Groups.size());
+    m_Groups.push_back({ base, spec });
+    m_Bases[base].groupsBySpec.insert(spec, group);
+    if (spec.isEmpty()) {
+        m_Bases[base].plainGroup = group;
+    }
+    else {
+        m_Bases[base].groups.push_back(group);
+    }
+    return group;
+}
+
+/**
+ * @brief Registers the HELM task prompts come from; a task is only stored once.
+ *
+ * @param task The dataset name, HELM data path and run directory of the task.
+ * @return TaskId The id of the task.
+ */
+PromptStore::TaskId PromptStore::addTask(const Task& task)
+{
+    const QString key = task.helmDataPath + "/" + task.taskDir;
+    auto it = m_TasksByDir.constFind(key);
+    if (it == m_TasksByDir.cend()) {
+        it = m_TasksByDir.insert(key, static_cast<TaskId>(m_Tasks.size()));
+        m_Tasks.push_back(task);
+    }
+    return it.value();
+}
+
+/**
+ * @brief Appends a prompt to a group.
+ *
+ * @param group The group the prompt belongs to.
+ * @param id The HELM instance id.
+ * @param task The task holding the instance.
+ * @param instance The position of the instance in the task's instances.json.
+ * @return PromptId The id of the new prompt, or -1 if the group already holds a prompt with that id.
+ */
+PromptStore::PromptId PromptStore::addPrompt(const GroupId group, const QString& id, const TaskId task, const quint32 instance)
+{
+    if (findPrompt(group, id) >= 0) {
+        return -1;
+    }
+
+    const auto prompt = static_cast<PromptId>(m_PromptGroups.size());
+
+    m_PromptGroups.push_back(group);
+    m_PromptFlags.push_back(0);
+    m_PromptCids.push_back(0);
+    m_PromptTasks.push_back(task);
+    m_PromptInstances.push_back(instance);
+
+    m_Ids += id;
+    m_IdOffsets.push_back(m_Ids.size());
+
+    m_Groups[group].prompts.push_back(prompt);
+    m_Groups[group].promptsById.insert(qHash(QStringView(id)), prompt);
+    return prompt;
+}
+
+/**
+ * @brief Makes room for a batch of prompts, so that adding them does not reallocate the columns repeatedly.
+ *
+ * @param prompts The number of prompts about to be added.
+ * @param idLength The total length of their ids.
+ */
+void PromptStore::reserve(const qsizetype prompts, const qsizetype idLength)
+{
+    const qsizetype count = m_PromptGroups.size() + prompts;
+    reserveFor(m_PromptGroups, count);
+    reserveFor(m_PromptFlags, count);
+    reserveFor(m_PromptCids, count);
+    reserveFor(m_PromptTasks, count);
+    reserveFor(m_PromptInstances, count);
+    reserveFor(m_IdOffsets, count + 1);
+    reserveFor(m_Ids, m_Ids.size() + idLength);
+}
+
+/**
+ * @brief Looks up a base that has not been removed.
+ *
+ * @param name The dataset base name.
+ * @return BaseId The id of the base, or -1.
+ */
+PromptStore::BaseId PromptStore::findBase(const QString& name) const
+{
+    return m_BasesByName.value(name, -1);
+}
+
+/**
+ * @brief Looks up a group that has not been removed, nor has its base.
+ *
+ * @param datasetBase The dataset base name.
+ * @param datasetSpec The dataset specification, or an empty string.
+ * @return GroupId The id of the group, or -1.
+ */
+PromptStore::GroupId PromptStore::findGroup(const QString& datasetBase, const QString& datasetSpec) const
+{
+    const BaseId base = findBase(datasetBase);
+    if (base < 0) {
+        return -1;
+    }
+    return m_Bases.at(base).groupsBySpec.value(datasetSpec, -1);
+}
+
+/**
+ * @brief Checks whether a group holds a prompt with the given instance id that has not been removed.
+ *
+ * @param group The group to search.
+ * @param id The HELM instance id.
+ * @return bool True if the prompt is present.
+ */
+bool PromptStore::containsPrompt(const GroupId group, const QStringView id) const
+{
+    return findPrompt(group, id) >= 0;
+}
+
+qsizetype PromptStore::baseCount() const
+{
+    return m_Bases.size();
+}
+
+qsizetype PromptStore::groupCount() const
+{
+    return m_Groups.size();
+}
+
+qsizetype PromptStore::promptCount() const
+{
+    return m_PromptGroups.size();
+}
+
+const QString& PromptStore::baseName(const BaseId base) const
+{
+    return m_Bases.at(base).name;
+}
+
+/**
+ * @brief The groups of a base that have a dataset specification, in insertion order.
+ */
+const QList<PromptStore::GroupId>& PromptStore::groups(const BaseId base) const
+{
+    return m_Bases.at(base).groups;
+}
+
+/**
+ * @brief The group of a base without dataset specification, or -1.
+ */
+PromptStore::GroupId PromptStore::plainGroup(const BaseId base) const
+{
+    return m_Bases.at(base).plainGroup;
+}
+
+PromptStore::BaseId PromptStore::groupBase(const GroupId group) const
+{
+    return m_Groups.at(group).base;
+}
+
+const QString& PromptStore::groupSpec(const GroupId group) const
+{
+    return m_Groups.at(group).spec;
+}
+
+/**
+ * @brief The prompts of a group, removed ones included, in insertion order.
+ */
+const QList<PromptStore::PromptId>& PromptStore::prompts(const GroupId group) const
+{
+    return m_Groups.at(group).prompts;
+}
+
+const PromptStore::Task& PromptStore::task(const TaskId task) const
+{
+    return m_Tasks.at(task);
+}
+
+PromptStore::GroupId PromptStore::promptGroup(const PromptId prompt) const
+{
+    return m_PromptGroups.at(prompt);
+}
+
+/**
+ * @brief The HELM instance id of a prompt; the view is invalidated by the next addPrompt().
+ */
+QStringView PromptStore::promptId(const PromptId prompt) const
+{
+    const qsizetype begin = m_IdOffsets.at(prompt);
+    return QStringView(m_Ids).sliced(begin, m_IdOffsets.at(prompt + 1) - begin);
+}
+
+PromptStore::TaskId PromptStore::promptTask(const PromptId prompt) const
+{
+    return m_PromptTasks.at(prompt);
+}
+
+/**
+ * @brief The position of a prompt's instance in the instances.json of its task.
+ */
+quint32 PromptStore::promptInstance(const PromptId prompt) const
+{
+    return m_PromptInstances.at(prompt);
+}
+
+const QString& PromptStore::cid(const PromptId prompt) const
+{
+    return m_Cids.at(m_PromptCids.at(prompt));
+}
+
+/**
+ * @brief The interned index of a prompt's CID; 0 stands for no CID.
+ */
+qint32 PromptStore::cidIndex(const PromptId prompt) const
+{
+    return m_PromptCids.at(prompt);
+}
+
+/**
+ * @brief The interned index of a CID, or -1 if no prompt has ever been given it.
+ */
+qint32 PromptStore::findCid(const QString& cid) const
+{
+    return m_CidIndices.value(cid, -1);
+}
+
+void PromptStore::setCid(const PromptId prompt, const QString& cid)
+{
+    const qint32 index = internCid(cid);
+    if (index == m_PromptCids.at(prompt)) {
+        return;
+    }
+    const bool indexed = (m_PromptFlags.at(prompt) & Removed) == 0;
+    if (indexed) {
+        unindexCid(prompt);
+    }
+    m_PromptCids[prompt] = index;
+    if (indexed) {
+        indexCid(prompt);
+    }
+}
+
+/**
+ * @brief The number of interned CIDs, including the empty one at index 0.
+ */
+qint32 PromptStore::cidCount() const
+{
+    return static_cast<qint32>(m_Cids.size());
+}
+
+const QString& PromptStore::cidName(const qint32 cid) const
+{
+    return m_Cids.at(cid);
+}
+
+/**
+ * @brief The prompts holding a CID that have not been removed themselves; their group or base may have been.
+ *
+ * @param cid An interned CID other than 0.
+ */
+const QSet<PromptStore::PromptId>& PromptStore::cidPrompts(const qint32 cid) const
+{
+    return m_CidPrompts.at(cid).prompts;
+}
+
+/**
+ * @brief The number of cidPrompts() in each group.
+ *
+ * @param cid An interned CID other than 0.
+ */
+const QHash<PromptStore::GroupId, qint32>& PromptStore::cidGroupCounts(const qint32 cid) const
+{
+    return m_CidPrompts.at(cid).countsByGroup;
+}
+
+bool PromptStore::isSelected(const PromptId prompt) const
+{
+    return (m_PromptFlags.at(prompt) & Selected) != 0;
+}
+
+void PromptStore::setSelected(const PromptId prompt, const bool selected)
+{
+    if (selected) {
+        m_PromptFlags[prompt] |= Selected;
+    }
+    else {
+        m_PromptFlags[prompt] &= ~Selected;
+    }
+}
+
+bool PromptStore::isRemoved(const Node node) const
+{
+    switch (node.kind) {
+    case Node::Base:
+        return m_Bases.at(node.id).removed;
+    case Node::Group:
+        return m_Groups.at(node.id).removed;
+    case Node::Prompt:
+        return (m_PromptFlags.at(node.id) & Removed) != 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks that neither a prompt, nor its group, nor its base has been removed.
+ */
+bool PromptStore::isAttached(const PromptId prompt) const
+{
+    const Group& group = m_Groups.at(m_PromptGroups.at(prompt));
+    return (m_PromptFlags.at(prompt) & Removed) == 0 && !group.removed && !m_Bases.at(group.base).removed;
+}
+
+/**
+ * @brief Flags a node as removed and takes it out of the indices.
+ *
+ * @param node The node.
+ */
+void PromptStore::remove(const Node node)
+{
+    if (isRemoved(node)) {
+        return;
+    }
+
+    switch (node.kind) {
+    case Node::Base: {
+        Base& base = m_Bases[node.id];
+        m_BasesByName.remove(base.name);
+        base.removed = true;
+        break;
+    }
+    case Node::Group: {
+        Group& group = m_Groups[node.id];
+        m_Bases[group.base].groupsBySpec.remove(group.spec);
+        group.removed = true;
+        break;
+    }
+    case Node::Prompt: {
+        Group& group = m_Groups[m_PromptGroups.at(node.id)];
+        group.promptsById.remove(qHash(promptId(node.id)), node.id);
+        unindexCid(node.id);
+        m_PromptFlags[node.id] |= Removed;
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Clears the removed flag of a node and puts it back in the indices.
+ *
+ * @param node The node.
+ * @return bool False if another node with the same name, spec or instance id has taken its place.
+ */
+bool PromptStore::restore(const Node node)
+{
+    if (!isRemoved(node)) {
+        return false;
+    }
+
+    switch (node.kind) {
+    case Node::Base: {
+        Base& base = m_Bases[node.id];
+        if (m_BasesByName.contains(base.name)) {
+            return false;
+        }
+        m_BasesByName.insert(base.name, node.id);
+        base.removed = false;
+        break;
+    }
+    case Node::Group: {
+        Group& group = m_Groups[node.id];
+        QHash<QString, GroupId>& groupsBySpec = m_Bases[group.base].groupsBySpec;
+        if (groupsBySpec.contains(group.spec)) {
+            return false;
+        }
+        groupsBySpec.insert(group.spec, node.id);
+        group.removed = false;
+        break;
+    }
+    case Node::Prompt: {
+        const GroupId group = m_PromptGroups.at(node.id);
+        const QStringView id = promptId(node.id);
+        if (findPrompt(group, id) >= 0) {
+            return false;
+        }
+        m_Groups[group].promptsById.insert(qHash(id), node.id);
+        m_PromptFlags[node.id] &= ~Removed;
+        indexCid(node.id);
+        break;
+    }
+    }
+    return true;
+}
+
+/**
+ * @brief Lists the attached prompts, grouped by base and group in insertion order.
+ *
+ * @return QList<PromptId> The prompts.
+ */
+QList<PromptStore::PromptId> PromptStore::attachedPrompts() const
+{
+    QList<PromptId> attached;
+    attached.reserve(m_PromptGroups.size());
+
+    const auto appendGroup = [&](const GroupId group) {
+        if (group < 0 || m_Groups.at(group).removed) {
+            return;
+        }
+        for (const PromptId prompt : m_Groups.at(group).prompts) {
+            if ((m_PromptFlags.at(prompt) & Removed) == 0) {
+                attached.push_back(prompt);
+            }
+        }
+    };
+
+    for (const Base& base : m_Bases) {
+        if (base.removed) {
+            continue;
+        }
+        for (const GroupId group : base.groups) {
+            appendGroup(group);
+        }
+        appendGroup(base.plainGroup);
+    }
+    return attached;
+}
+
+void PromptStore::clear()
+{
+    m_Bases.clear();
+    m_BasesByName.clear();
+    m_Groups.clear();
+    m_Tasks.clear();
+    m_TasksByDir.clear();
+    m_PromptGroups.clear();
+    m_PromptFlags.clear();
+    m_PromptCids.clear();
+    m_PromptTasks.clear();
+    m_PromptInstances.clear();
+    m_Ids.clear();
+    m_IdOffsets = { 0 };
+    m_Cids = { QString() };
+    m_CidIndices = { { QString(), 0 } };
+    m_CidPrompts = { CidPrompts() };
+}
+
+/**
+ * @brief Looks up a prompt of a group that has not been removed.
+ *
+ * @param group The group to search.
+ * @param id The HELM instance id.
+ * @return PromptId The prompt, or -1.
+ */
+PromptStore::PromptId PromptStore::findPrompt(const GroupId group, const QStringView id) const
+{
+    const QMultiHash<size_t, PromptId>& promptsById = m_Groups.at(group).promptsById;
+    const size_t key = qHash(id);
+    for (auto it = promptsById.constFind(key); it != promptsById.cend() && it.key() == key; ++it) {
+        if (promptId(it.value()) == id) {
+            return it.value();
+        }
+    }
+    return -1;
+}
+
+qint32 PromptStore::internCid(const QString& cid)
+{
+    auto it = m_CidIndices.constFind(cid);
+    if (it == m_CidIndices.cend()) {
+        it = m_CidIndices.insert(cid, static_cast<qint32>(m_Cids.size()));
+        m_Cids.push_back(cid);
+        m_CidPrompts.push_back({});
+    }
+    return it.value();
+}
+
+void PromptStore::indexCid(const PromptId prompt)
+{
+    const qint32 cid = m_PromptCids.at(prompt);
+    if (cid == 0) {
+        return;
+    }
+    CidPrompts& entry = m_CidPrompts[cid];
+    entry.prompts.insert(prompt);
+    ++entry.countsByGroup[m_PromptGroups.at(prompt)];
+}
+
+void PromptStore::unindexCid(const PromptId prompt)
+{
+    const qint32 cid = m_PromptCids.at(prompt);
+    if (cid == 0) {
+        return;
+    }
+    CidPrompts& entry = m_CidPrompts[cid];
+    entry.prompts.remove(prompt);
+    const auto count = entry.countsByGroup.find(m_PromptGroups.at(prompt));
+    if (count != entry.countsByGroup.end() && --count.value() == 0) {
+        entry.countsByGroup.erase(count);
+    }
+}
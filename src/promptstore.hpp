@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @brief Columnar storage for the prompts of the working set.
+ *
+ * Prompts are numbered in insertion order and every attribute lives in its own
+ * column indexed by that number: the group (dataset base and spec) they belong
+ * to, a flag byte, an interned CID, and the HELM task and position in it of the
+ * instance they come from. Prompt ids are appended to a single text arena and
+ * located through offsets. Prompt and references texts are not stored: they are
+ * formatted from the instance when needed (see PromptTextCache), so a prompt
+ * costs a few dozen bytes plus its id.
+ *
+ * Dataset bases, their (sub)dataset groups and the prompts of each group are
+ * kept in insertion order. Nodes are never erased: removing one only flags it,
+ * so it can be restored later and its id stays valid until clear().
+ *
+ * Bases are indexed by name, groups by spec within their base, and prompts by
+ * the hash of their instance id within their group. Only nodes that have not
+ * been removed are indexed, so a dataset or prompt is never present twice: a
+ * node cannot be restored while another one with the same key took its place.
+ * Prompts are also indexed by CID, with their count per group, so that the
+ * prompts holding a CID are found without scanning the store.
+ */
+class PromptStore
+{
+public:
+    using BaseId = qint32;
+    using GroupId = qint32;
+    using PromptId = qint32;
+    using TaskId = qint32;
+
+    /**
+     * @brief A HELM task whose instances prompts come from.
+     */
+    struct Task
+    {
+        QString dataset;
+        QString helmDataPath;
+        QString taskDir;
+    };
+
+    /**
+     * @brief Refers to a dataset base, a (sub)dataset group or a prompt.
+     */
+    struct Node
+    {
+        enum Kind : quint8 { Base, Group, Prompt };
+
+        Kind kind = Prompt;
+        qint32 id = -1;
+    };
+
+    BaseId addBase(const QString& name);
+    GroupId addGroup(BaseId base, const QString& spec);
+    TaskId addTask(const Task& task);
+    PromptId addPrompt(GroupId group, const QString& id, TaskId task, quint32 instance);
+    void reserve(qsizetype prompts, qsizetype idLength);
+
+    BaseId findBase(const QString& name) const;
+    GroupId findGroup(const QString& datasetBase, const QString& datasetSpec) const;
+    bool containsPrompt(GroupId group, QStringView id) const;
+
+    qsizetype baseCount() const;
+    qsizetype groupCount() const;
+    qsizetype promptCount() const;
+
+    const QString& baseName(BaseId base) const;
+    const QList<GroupId>& groups(BaseId base) const;
+    GroupId plainGroup(BaseId base) const;
+
+    BaseId groupBase(GroupId group) const;
+    const QString& groupSpec(GroupId group) const;
+    const QList<PromptId>& prompts(GroupId group) const;
+
+    const Task& task(TaskId task) const;
+
+    GroupId promptGroup(PromptId prompt) const;
+    QStringView promptId(PromptId prompt) const;
+    TaskId promptTask(PromptId prompt) const;
+    quint32 promptInstance(PromptId prompt) const;
+
+    const QString& cid(PromptId prompt) const;
+    qint32 cidIndex(PromptId prompt) const;
+    qint32 findCid(const QString& cid) const;
+    void setCid(PromptId prompt, const QString& cid);
+
+    qint32 cidCount() const;
+    const QString& cidName(qint32 cid) const;
+    const QSet<PromptId>& cidPrompts(qint32 cid) const;
+    const QHash<GroupId, qint32>& cidGroupCounts(qint32 cid) const;
+
+    bool isSelected(PromptId prompt) const;
+    void setSelected(PromptId prompt, bool selected);
+
+    bool isRemoved(Node node) const;
+    bool isAttached(PromptId prompt) const;
+    void remove(Node node);
+    bool restore(Node node);
+
+    QList<PromptId> attachedPrompts() const;
+
+    void clear();
+
+private:
+    enum Flag : quint8 {
+        Selected = 0x1,
+        Removed = 0x2,
+    };
+
+    struct Base
+    {
+        QString name;
+        QList<GroupId> groups;
+        GroupId plainGroup = -1;
+        QHash<QString, GroupId> groupsBySpec;
+        bool removed = false;
+    };
+
+    struct Group
+    {
+        BaseId base = -1;
+        QString spec;
+        QList<PromptId> prompts;
+        QMultiHash<size_t, PromptId> promptsById;
+        bool removed = false;
+    };
+
+    /**
+     * @brief The prompts holding a CID that are not removed themselves, and how many of them each group has.
+     */
+    struct CidPrompts
+    {
+        QSet<PromptId> prompts;
+        QHash<GroupId, qint32> countsByGroup;
+    };
+
+    PromptId findPrompt(GroupId group, QStringView id) const;
+    qint32 internCid(const QString& cid);
+    void indexCid(PromptId prompt);
+    void unindexCid(PromptId prompt);
+
+    QList<Base> m_Bases;
+    QHash<QString, BaseId> m_BasesByName;
+    QList<Group> m_Groups;
+    QList<Task> m_Tasks;
+    QHash<QString, TaskId> m_TasksByDir;
+
+    // one entry per prompt
+    QList<GroupId> m_PromptGroups;
+    QList<quint8> m_PromptFlags;
+    QList<qint32> m_PromptCids;
+    QList<TaskId> m_PromptTasks;
+    QList<quint32> m_PromptInstances;
+
+    // the id of prompt i spans m_Ids[m_IdOffsets[i] .. m_IdOffsets[i + 1]]
+    QString m_Ids;
+    QList<qsizetype> m_IdOffsets = { 0 };
+
+    QStringList m_Cids = { QString() };
+    QHash<QString, qint32> m_CidIndices = { { QString(), 0 } };
+    QList<CidPrompts> m_CidPrompts = { CidPrompts() };    // indexed by interned CID; the empty CID is not tracked
+};
@@ -0,0 +1,144 @@
+#include "prompttextcache.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+#include <QHash>
+
+#include "helperfunctions.hpp"
+
+/**
+ * @brief Groups prompts by the HELM task of their instances, so that each task is read once.
+ *
+ * @param store The prompt store.
+ * @param prompts The prompts to group.
+ * @return QList<TaskPrompts> One entry per task, in order of first appearance; within it, prompts are sorted by instance.
+ */
+QList<TaskPrompts> groupPromptsByTask(const PromptStore& store, const QList<PromptStore::PromptId>& prompts)
+{
+    QList<TaskPrompts> tasks;
+    QHash<PromptStore::TaskId, qsizetype> taskIndices;
+
+    for (const PromptStore::PromptId prompt : prompts) {
+        const PromptStore::TaskId task = store.promptTask(prompt);
+        auto it = taskIndices.constFind(task);
+        if (it == taskIndices.cend()) {
+            it = taskIndices.insert(task, tasks.size());
+            tasks.push_back({ store.task(task), {}, {}, {} });
+        }
+        tasks[it.value()].instances.push_back(store.promptInstance(prompt));
+        tasks[it.value()].prompts.push_back(prompt);
+        tasks[it.value()].ids.push_back(store.promptId(prompt).toString());
+    }
+
+    for (TaskPrompts& task : tasks) {
+        if (std::ranges::is_sorted(task.instances)) {
+            continue;
+        }
+        QList<qsizetype> order(task.instances.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, {}, [&](const qsizetype i) { return task.instances.at(i); });
+
+        TaskPrompts sorted { task.task, {}, {}, {} };
+        sorted.instances.reserve(order.size());
+        sorted.prompts.reserve(order.size());
+        sorted.ids.reserve(order.size());
+        for (const qsizetype i : order) {
+            sorted.instances.push_back(task.instances.at(i));
+            sorted.prompts.push_back(task.prompts.at(i));
+            sorted.ids.push_back(task.ids.at(i));
+        }
+        task = std::move(sorted);
+    }
+
+    return tasks;
+}
+
+/**
+ * @brief Formats the prompt texts of some prompts of a task, reading each instance once.
+ *
+ * A prompt is only loaded if its instance can be read and still has the prompt's
+ * id, i.e. instances.json did not change since the prompt was added.
+ *
+ * @param prompts The prompts, as returned by groupPromptsByTask().
+ * @param cachePath The directory holding instance caches; empty to disable caching.
+ * @return LoadedPromptTexts The prompt texts, in the same order, and which of them were loaded.
+ */
+LoadedPromptTexts loadPromptTexts(const TaskPrompts& prompts, const QString& cachePath)
+{
+    LoadedPromptTexts result { QStringList(prompts.instances.size()), QBitArray(prompts.instances.size()), QString() };
+
+    const std::unique_ptr<InstanceReader> instances = getSelectedTaskInstances(prompts.task.taskDir, prompts.task.helmDataPath, cachePath, prompts.instances);
+    if (!instances) {
+        result.error = "Failed to open instances.json from " + prompts.task.taskDir;
+        return result;
+    }
+
+    TaskInstance instance;
+    qsizetype i = 0;
+    while (i < prompts.instances.size() && instances->next(instance)) {
+        // readers skip requested instances they cannot reach, so match them up by position
+        while (i < prompts.instances.size() && prompts.instances.at(i) < instance.index) {
+            ++i;
+        }
+        if (i < prompts.instances.size() && prompts.instances.at(i) == instance.index) {
+            if (instance.id == prompts.ids.at(i)) {
+                result.texts[i] = getPromptText(instance, prompts.task.dataset);
+                result.loaded.setBit(i);
+            }
+            ++i;
+        }
+    }
+
+    if (!instances->errorString().isEmpty()) {
+        result.error = "Error reading instances.json from " + prompts.task.taskDir + ":\n" + instances->errorString();
+    }
+    else if (result.loaded.count(true) < result.loaded.size()) {
+        result.error = "Some prompts of " + prompts.task.dataset + " are no longer in instances.json from " + prompts.task.taskDir;
+    }
+    return result;
+}
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param capacity The number of prompts whose texts are kept.
+ */
+PromptTextCache::PromptTextCache(const int capacity)
+    : m_Texts(capacity)
+{
+}
+
+/**
+ * @brief Returns the formatted texts of a prompt, formatting them from its instance if they are not cached.
+ *
+ * @param store The prompt store holding the prompt.
+ * @param prompt The prompt.
+ * @param cachePath The directory holding instance caches; empty to disable caching.
+ * @return PromptTexts The texts; empty if the instance could not be read or no longer has the prompt's id.
+ */
+PromptTexts PromptTextCache::texts(const PromptStore& store, const PromptStore::PromptId prompt, const QString& cachePath)
+{
+    const quint64 key = (quint64(quint32(store.promptTask(prompt))) << 32) | store.promptInstance(prompt);
+    if (const PromptTexts* cached = m_Texts.object(key)) {
+        return *cached;
+    }
+
+    const PromptStore::Task& task = store.task(store.promptTask(prompt));
+    const std::unique_ptr<InstanceReader> instances = getSelectedTaskInstances(task.taskDir, task.helmDataPath, cachePath, { store.promptInstance(prompt) });
+
+    TaskInstance instance;
+    if (!instances || !instances->next(instance) || instance.id != store.promptId(prompt)) {
+        return {};
+    }
+
+    PromptTexts texts { getPromptText(instance, task.dataset), getReferencesText(instance, task.dataset) };
+    m_Texts.insert(key, new PromptTexts(texts));
+    return texts;
+}
+
+void PromptTextCache::clear()
+{
+    m_Texts.clear();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QBitArray>
+#include <QCache>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "promptstore.hpp"
+
+/**
+ * @brief The formatted prompt and references texts of a prompt.
+ */
+struct PromptTexts {
+    QString prompt;
+    QString references;
+};
+
+/**
+ * @brief Prompts of the same HELM task, sorted by the position of their instances.
+ */
+struct TaskPrompts {
+    PromptStore::Task task;
+    QList<quint32> instances;
+    QList<PromptStore::PromptId> prompts;
+    QStringList ids;
+};
+
+/**
+ * @brief The prompt texts of some prompts of a task, and which of them could be read.
+ */
+struct LoadedPromptTexts {
+    QStringList texts;
+    QBitArray loaded;   // prompts whose instance was read and still has the prompt's id
+    QString error;      // set when some prompt was not loaded
+};
+
+QList<TaskPrompts> groupPromptsByTask(const PromptStore& store, const QList<PromptStore::PromptId>& prompts);
+LoadedPromptTexts loadPromptTexts(const TaskPrompts& prompts, const QString& cachePath);
+
+/**
+ * @brief Formats prompt texts on demand and keeps the most recently used ones.
+ *
+ * The prompt store only holds the task and instance of each prompt; viewing a
+ * prompt reads its instance again (from the binary cache when there is one) and
+ * formats it. Entries are keyed by task and instance, so they must be dropped
+ * with clear() whenever the store is cleared.
+ */
+class PromptTextCache
+{
+public:
+    explicit PromptTextCache(int capacity = 256);
+
+    PromptTexts texts(const PromptStore& store, PromptStore::PromptId prompt, const QString& cachePath);
+    void clear();
+
+private:
+    QCache<quint64, PromptTexts> m_Texts;
+};
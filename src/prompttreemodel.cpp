@@ -0,0 +1,772 @@
+#include "prompttreemodel.hpp"
+
+#include <algorithm>
+
+#include <QBrush>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+
+#include "hpb_globals.hpp"
+
+using BaseId = PromptStore::BaseId;
+using GroupId = PromptStore::GroupId;
+using PromptId = PromptStore::PromptId;
+
+namespace {
+    // batches with more nodes reset the model instead of emitting a signal per row
+    constexpr qsizetype maxRowSignals = 256;
+
+    qsizetype sortedIndexOf(const QList<qint32>& list, const qint32 id)
+    {
+        const auto it = std::lower_bound(list.cbegin(), list.cend(), id);
+        return it != list.cend() && *it == id ? it - list.cbegin() : -1;
+    }
+
+    qsizetype sortedPosition(const QList<qint32>& list, const qint32 id)
+    {
+        return std::lower_bound(list.cbegin(), list.cend(), id) - list.cbegin();
+    }
+} // namespace
+
+PromptTreeModel::PromptTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{}
+
+/********************************
+ * QAbstractItemModel interface *
+ ********************************/
+
+QModelIndex PromptTreeModel::index(const int row, const int column, const QModelIndex& parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return {};
+    }
+    if (!parent.isValid()) {
+        return createIndex(row, column, quintptr(0));
+    }
+
+    const Node parentNode = node(parent);
+    switch (parentNode.kind) {
+    case Node::Base:
+        return createIndex(row, column, childrenOfBase(parentNode.id));
+    case Node::Group:
+        return createIndex(row, column, childrenOfGroup(parentNode.id));
+    case Node::Prompt:
+        break;
+    }
+    return {};
+}
+
+QModelIndex PromptTreeModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.internalId() == 0) {
+        return {};
+    }
+
+    const quintptr id = index.internalId();
+    if (id % 2 == 1) {
+        return baseIndex(static_cast<BaseId>((id - 1) / 2));
+    }
+    return groupIndex(static_cast<GroupId>((id - 2) / 2));
+}
+
+int PromptTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    if (!parent.isValid()) {
+        return static_cast<int>(m_Bases.size());
+    }
+
+    const Node parentNode = node(parent);
+    switch (parentNode.kind) {
+    case Node::Base: {
+        const GroupId plainGroup = m_Store.plainGroup(parentNode.id);
+        const qsizetype plainPrompts = plainGroup < 0 ? 0 : m_Prompts.at(plainGroup).size();
+        return static_cast<int>(m_Groups.at(parentNode.id).size() + plainPrompts);
+    }
+    case Node::Group:
+        return static_cast<int>(m_Prompts.at(parentNode.id).size());
+    case Node::Prompt:
+        break;
+    }
+    return 0;
+}
+
+int PromptTreeModel::columnCount(const QModelIndex& /* parent */) const
+{
+    return HPB::PTColumnCount;
+}
+
+QVariant PromptTreeModel::data(const QModelIndex& index, const int role) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+
+    const Node current = node(index);
+    const bool isPrompt = current.kind == Node::Prompt;
+    const bool isCidColumn = index.column() == HPB::PTCIDColumn;
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        if (isCidColumn) {
+            return isPrompt ? QVariant(m_Store.cid(current.id)) : QVariant();
+        }
+        switch (current.kind) {
+        case Node::Base:
+            return m_Store.baseName(current.id);
+        case Node::Group:
+            return m_Store.groupSpec(current.id);
+        case Node::Prompt:
+            return m_Store.promptId(current.id).toString();
+        }
+        break;
+    case Qt::BackgroundRole:
+        if (isPrompt && isCidColumn) {
+            return QBrush(m_Store.isSelected(current.id) ? Qt::blue : Qt::lightGray);
+        }
+        break;
+    case Qt::ForegroundRole:
+        if (!isPrompt) {
+            break;
+        }
+        if (isCidColumn) {
+            return QBrush(m_Store.isSelected(current.id) ? Qt::white : Qt::black);
+        }
+        return QBrush(m_Store.isSelected(current.id) ? Qt::black : Qt::darkGray);
+    default:
+        break;
+    }
+    return {};
+}
+
+QVariant PromptTreeModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return {};
+    }
+    switch (section) {
+    case HPB::PTCIDColumn:
+        return QString("Custom Dataset ID");
+    case HPB::PTNameIDColumn:
+        return QString("Dataset name / Prompt ID");
+    default:
+        return {};
+    }
+}
+
+/*******************
+ * Store accessors *
+ *******************/
+
+const PromptStore& PromptTreeModel::store() const
+{
+    return m_Store;
+}
+
+/**
+ * @brief Identifies the base, group or prompt shown at an index.
+ *
+ * @param index An index of this model.
+ * @return Node The node; its id is -1 for an invalid index.
+ */
+PromptTreeModel::Node PromptTreeModel::node(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+
+    const quintptr id = index.internalId();
+    const int row = index.row();
+    if (id == 0) {
+        return { Node::Base, m_Bases.at(row) };
+    }
+    if (id % 2 == 1) {
+        const auto base = static_cast<BaseId>((id - 1) / 2);
+        const QList<GroupId>& groups = m_Groups.at(base);
+        if (row < groups.size()) {
+            return { Node::Group, groups.at(row) };
+        }
+        return { Node::Prompt, m_Prompts.at(m_Store.plainGroup(base)).at(row - groups.size()) };
+    }
+    return { Node::Prompt, m_Prompts.at(static_cast<GroupId>((id - 2) / 2)).at(row) };
+}
+
+/**
+ * @brief The prompt shown at an index.
+ *
+ * @param index An index of this model.
+ * @return PromptId The prompt, or -1 if the index does not show one.
+ */
+PromptStore::PromptId PromptTreeModel::prompt(const QModelIndex& index) const
+{
+    const Node current = node(index);
+    return current.kind == Node::Prompt ? current.id : -1;
+}
+
+/**
+ * @brief The prompts shown at a list of indices, e.g. the selected rows of a view.
+ *
+ * @param indexes Indices of this model; the ones not showing a prompt are skipped.
+ * @return QList<PromptId> The prompts.
+ */
+QList<PromptStore::PromptId> PromptTreeModel::prompts(const QModelIndexList& indexes) const
+{
+    QList<PromptId> result;
+    result.reserve(indexes.size());
+    for (const QModelIndex& index : indexes) {
+        const PromptId current = prompt(index);
+        if (current >= 0) {
+            result.push_back(current);
+        }
+    }
+    return result;
+}
+
+/*************
+ * Mutations *
+ *************/
+
+/**
+ * @brief Appends prompts to a dataset, creating its base and group when needed.
+ *
+ * All the prompts appear in a single row insertion.
+ *
+ * @param datasetBase The dataset base name.
+ * @param datasetSpec The dataset specification, or an empty string.
+ * @param task The HELM task the prompts' instances belong to.
+ * @param prompts The prompts to append.
+ */
+void PromptTreeModel::addPrompts(const QString& datasetBase, const QString& datasetSpec, const PromptStore::Task& task, const QList<NewPrompt>& prompts)
+{
+    if (prompts.isEmpty()) {
+        return;
+    }
+
+    BaseId base = m_Store.findBase(datasetBase);
+    if (base < 0) {
+        base = m_Store.addBase(datasetBase);
+        m_Groups.resize(m_Store.baseCount());
+    }
+    GroupId group = m_Store.findGroup(datasetBase, datasetSpec);
+    if (group < 0) {
+        group = m_Store.addGroup(base, datasetSpec);
+        m_Prompts.resize(m_Store.groupCount());
+    }
+
+    qsizetype idLength = 0;
+    for (const NewPrompt& newPrompt : prompts) {
+        idLength += newPrompt.id.size();
+    }
+    m_Store.reserve(prompts.size(), idLength);
+
+    const PromptStore::TaskId taskId = m_Store.addTask(task);
+    QList<PromptId> added;
+    added.reserve(prompts.size());
+    for (const NewPrompt& newPrompt : prompts) {
+        const PromptId id = m_Store.addPrompt(group, newPrompt.id, taskId, newPrompt.instance);
+        if (id >= 0 && accepts(id)) {
+            added.push_back(id);
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    const bool isPlain = datasetSpec.isEmpty();
+
+    // a dataset that is not shown yet appears with all its prompts at once
+    if (sortedIndexOf(m_Bases, base) < 0) {
+        m_Prompts[group] += added;
+        if (!isPlain && sortedIndexOf(m_Groups.at(base), group) < 0) {
+            m_Groups[base].insert(sortedPosition(m_Groups.at(base), group), group);
+        }
+        const auto row = static_cast<int>(sortedPosition(m_Bases, base));
+        beginInsertRows(QModelIndex(), row, row);
+        m_Bases.insert(row, base);
+        endInsertRows();
+        return;
+    }
+    if (!isPlain && sortedIndexOf(m_Groups.at(base), group) < 0) {
+        m_Prompts[group] += added;
+        const auto row = static_cast<int>(sortedPosition(m_Groups.at(base), group));
+        beginInsertRows(baseIndex(base), row, row);
+        m_Groups[base].insert(row, group);
+        endInsertRows();
+        return;
+    }
+
+    const int first = firstPromptRow(group) + static_cast<int>(m_Prompts.at(group).size());
+    beginInsertRows(isPlain ? baseIndex(base) : groupIndex(group), first, first + static_cast<int>(added.size()) - 1);
+    m_Prompts[group] += added;
+    endInsertRows();
+}
+
+/**
+ * @brief Assigns a CID to prompts.
+ *
+ * @param prompts The prompts.
+ * @param cid The CID; an empty string clears it.
+ */
+void PromptTreeModel::setCid(const QList<PromptStore::PromptId>& prompts, const QString& cid)
+{
+    for (const PromptId current : prompts) {
+        m_Store.setCid(current, cid);
+    }
+    emitPromptsChanged(prompts);
+    emit cidsChanged();
+}
+
+/**
+ * @brief Marks prompts as selected for, or excluded from, the compilation.
+ *
+ * @param prompts The prompts.
+ * @param selected The new selection status.
+ */
+void PromptTreeModel::setSelected(const QList<PromptStore::PromptId>& prompts, const bool selected)
+{
+    for (const PromptId current : prompts) {
+        m_Store.setSelected(current, selected);
+    }
+    emitPromptsChanged(prompts);
+}
+
+/**
+ * @brief Removes a base, group or prompt from the tree; it can be put back with restoreNode().
+ *
+ * @param node The node to remove.
+ */
+void PromptTreeModel::removeNode(const Node node)
+{
+    if (node.id < 0 || m_Store.isRemoved(node)) {
+        return;
+    }
+
+    switch (node.kind) {
+    case Node::Base: {
+        const auto row = static_cast<int>(sortedIndexOf(m_Bases, node.id));
+        if (row >= 0) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_Bases.removeAt(row);
+            endRemoveRows();
+        }
+        break;
+    }
+    case Node::Group: {
+        const BaseId base = m_Store.groupBase(node.id);
+        const auto row = static_cast<int>(sortedIndexOf(m_Groups.at(base), node.id));
+        if (row < 0) {
+            break;
+        }
+        const bool shown = sortedIndexOf(m_Bases, base) >= 0;
+        if (shown) {
+            beginRemoveRows(baseIndex(base), row, row);
+        }
+        m_Groups[base].removeAt(row);
+        if (shown) {
+            endRemoveRows();
+        }
+        break;
+    }
+    case Node::Prompt: {
+        const GroupId group = m_Store.promptGroup(node.id);
+        const qsizetype position = sortedIndexOf(m_Prompts.at(group), node.id);
+        if (position < 0) {
+            break;
+        }
+        const bool shown = isShown(group);
+        if (shown) {
+            const int row = firstPromptRow(group) + static_cast<int>(position);
+            const bool isPlain = m_Store.groupSpec(group).isEmpty();
+            beginRemoveRows(isPlain ? baseIndex(m_Store.groupBase(group)) : groupIndex(group), row, row);
+        }
+        m_Prompts[group].removeAt(position);
+        if (shown) {
+            endRemoveRows();
+        }
+        break;
+    }
+    }
+
+    m_Store.remove(node);
+    emit cidsChanged();
+}
+
+/**
+ * @brief Puts a removed base, group or prompt back in its original place.
+ *
+ * @param node The node to restore.
+ * @return bool False if the node was not removed, or if another node with the same key has taken its place.
+ */
+bool PromptTreeModel::restoreNode(const Node node)
+{
+    if (node.id < 0 || !m_Store.restore(node)) {
+        return false;
+    }
+
+    switch (node.kind) {
+    case Node::Base: {
+        if (m_CidFilter && !hasShownChildren(node.id)) {
+            break;
+        }
+        const auto row = static_cast<int>(sortedPosition(m_Bases, node.id));
+        beginInsertRows(QModelIndex(), row, row);
+        m_Bases.insert(row, node.id);
+        endInsertRows();
+        break;
+    }
+    case Node::Group: {
+        if (m_CidFilter && m_Prompts.at(node.id).isEmpty()) {
+            break;
+        }
+        const BaseId base = m_Store.groupBase(node.id);
+        const auto row = static_cast<int>(sortedPosition(m_Groups.at(base), node.id));
+        const bool shown = sortedIndexOf(m_Bases, base) >= 0;
+        if (shown) {
+            beginInsertRows(baseIndex(base), row, row);
+        }
+        m_Groups[base].insert(row, node.id);
+        if (shown) {
+            endInsertRows();
+        }
+        break;
+    }
+    case Node::Prompt: {
+        if (!accepts(node.id)) {
+            break;
+        }
+        const GroupId group = m_Store.promptGroup(node.id);
+        const qsizetype position = sortedPosition(m_Prompts.at(group), node.id);
+        const bool shown = isShown(group);
+        if (shown) {
+            const int row = firstPromptRow(group) + static_cast<int>(position);
+            const bool isPlain = m_Store.groupSpec(group).isEmpty();
+            beginInsertRows(isPlain ? baseIndex(m_Store.groupBase(group)) : groupIndex(group), row, row);
+        }
+        m_Prompts[group].insert(position, node.id);
+        if (shown) {
+            endInsertRows();
+        }
+        break;
+    }
+    }
+    emit cidsChanged();
+    return true;
+}
+
+/**
+ * @brief Removes several nodes as one change; they can be put back with restoreNodes().
+ *
+ * Small batches are removed row by row. Larger ones, e.g. the prompts removed
+ * by a filter, reset the model once, since a view handles a row signal in time
+ * proportional to its size.
+ *
+ * @param nodes The nodes to remove.
+ */
+void PromptTreeModel::removeNodes(const QList<Node>& nodes)
+{
+    if (nodes.size() <= maxRowSignals) {
+        for (const Node node : nodes) {
+            removeNode(node);
+        }
+        return;
+    }
+
+    beginResetModel();
+    QSet<GroupId> touchedGroups;
+    for (const Node node : nodes) {
+        if (node.id < 0 || m_Store.isRemoved(node)) {
+            continue;
+        }
+        switch (node.kind) {
+        case Node::Base:
+            if (const qsizetype row = sortedIndexOf(m_Bases, node.id); row >= 0) {
+                m_Bases.removeAt(row);
+            }
+            break;
+        case Node::Group: {
+            const BaseId base = m_Store.groupBase(node.id);
+            if (const qsizetype row = sortedIndexOf(m_Groups.at(base), node.id); row >= 0) {
+                m_Groups[base].removeAt(row);
+            }
+            break;
+        }
+        case Node::Prompt:
+            touchedGroups.insert(m_Store.promptGroup(node.id));
+            break;
+        }
+        m_Store.remove(node);
+    }
+    for (const GroupId group : std::as_const(touchedGroups)) {
+        m_Prompts[group].removeIf([this](const PromptId prompt) { return m_Store.isRemoved({ Node::Prompt, prompt }); });
+    }
+    endResetModel();
+    emit cidsChanged();
+}
+
+/**
+ * @brief Puts several removed nodes back as one change.
+ *
+ * @param nodes The nodes to restore.
+ * @return QList<Node> The nodes that were restored (see restoreNode()).
+ */
+QList<PromptStore::Node> PromptTreeModel::restoreNodes(const QList<Node>& nodes)
+{
+    QList<Node> restored;
+    if (nodes.size() <= maxRowSignals) {
+        for (const Node node : nodes) {
+            if (restoreNode(node)) {
+                restored.push_back(node);
+            }
+        }
+        return restored;
+    }
+
+    beginResetModel();
+    QSet<GroupId> touchedGroups;
+    for (const Node node : nodes) {
+        if (node.id < 0 || !m_Store.restore(node)) {
+            continue;
+        }
+        restored.push_back(node);
+        switch (node.kind) {
+        case Node::Base:
+            if (!m_CidFilter || hasShownChildren(node.id)) {
+                m_Bases.insert(sortedPosition(m_Bases, node.id), node.id);
+            }
+            break;
+        case Node::Group:
+            if (!m_CidFilter || !m_Prompts.at(node.id).isEmpty()) {
+                const BaseId base = m_Store.groupBase(node.id);
+                m_Groups[base].insert(sortedPosition(m_Groups.at(base), node.id), node.id);
+            }
+            break;
+        case Node::Prompt:
+            if (accepts(node.id)) {
+                const GroupId group = m_Store.promptGroup(node.id);
+                m_Prompts[group].push_back(node.id);
+                touchedGroups.insert(group);
+            }
+            break;
+        }
+    }
+    for (const GroupId group : std::as_const(touchedGroups)) {
+        std::ranges::sort(m_Prompts[group]);
+    }
+    endResetModel();
+    emit cidsChanged();
+
+    return restored;
+}
+
+/**
+ * @brief Removes every prompt and dataset, and the CID filter.
+ */
+void PromptTreeModel::clear()
+{
+    beginResetModel();
+    m_Store.clear();
+    m_CidFilter.reset();
+    m_Bases.clear();
+    m_Groups.clear();
+    m_Prompts.clear();
+    endResetModel();
+    emit cidsChanged();
+}
+
+/**
+ * @brief Shows only the prompts with a CID, and the datasets containing them.
+ *
+ * The filter is applied to the prompts present now; later changes to their CIDs
+ * do not hide or show them until the filter is set again.
+ *
+ * @param cid The CID.
+ */
+void PromptTreeModel::setCidFilter(const QString& cid)
+{
+    beginResetModel();
+    m_CidFilter = m_Store.findCid(cid);
+    rebuild();
+    endResetModel();
+}
+
+void PromptTreeModel::clearCidFilter()
+{
+    beginResetModel();
+    m_CidFilter.reset();
+    rebuild();
+    endResetModel();
+}
+
+/***********
+ * Helpers *
+ ***********/
+
+quintptr PromptTreeModel::childrenOfBase(const PromptStore::BaseId base)
+{
+    return 2 * static_cast<quintptr>(base) + 1;
+}
+
+quintptr PromptTreeModel::childrenOfGroup(const PromptStore::GroupId group)
+{
+    return 2 * static_cast<quintptr>(group) + 2;
+}
+
+bool PromptTreeModel::accepts(const PromptStore::PromptId prompt) const
+{
+    return !m_CidFilter || m_Store.cidIndex(prompt) == *m_CidFilter;
+}
+
+bool PromptTreeModel::hasShownChildren(const PromptStore::BaseId base) const
+{
+    const GroupId plainGroup = m_Store.plainGroup(base);
+    return !m_Groups.at(base).isEmpty() || (plainGroup >= 0 && !m_Prompts.at(plainGroup).isEmpty());
+}
+
+/**
+ * @brief Checks whether the prompts of a group are rows of the tree.
+ */
+bool PromptTreeModel::isShown(const PromptStore::GroupId group) const
+{
+    const BaseId base = m_Store.groupBase(group);
+    if (sortedIndexOf(m_Bases, base) < 0) {
+        return false;
+    }
+    return m_Store.groupSpec(group).isEmpty() || sortedIndexOf(m_Groups.at(base), group) >= 0;
+}
+
+QModelIndex PromptTreeModel::baseIndex(const PromptStore::BaseId base) const
+{
+    const qsizetype row = sortedIndexOf(m_Bases, base);
+    return row < 0 ? QModelIndex() : createIndex(static_cast<int>(row), 0, quintptr(0));
+}
+
+QModelIndex PromptTreeModel::groupIndex(const PromptStore::GroupId group) const
+{
+    const BaseId base = m_Store.groupBase(group);
+    const qsizetype row = sortedIndexOf(m_Groups.at(base), group);
+    return row < 0 ? QModelIndex() : createIndex(static_cast<int>(row), 0, childrenOfBase(base));
+}
+
+/**
+ * @brief The row of the first prompt of a group under its parent.
+ *
+ * The prompts of a dataset without specification follow the groups of its base.
+ */
+int PromptTreeModel::firstPromptRow(const PromptStore::GroupId group) const
+{
+    if (!m_Store.groupSpec(group).isEmpty()) {
+        return 0;
+    }
+    return static_cast<int>(m_Groups.at(m_Store.groupBase(group)).size());
+}
+
+QModelIndex PromptTreeModel::promptIndex(const PromptStore::PromptId prompt, const int column) const
+{
+    const GroupId group = m_Store.promptGroup(prompt);
+    if (!isShown(group)) {
+        return {};
+    }
+    const qsizetype position = sortedIndexOf(m_Prompts.at(group), prompt);
+    if (position < 0) {
+        return {};
+    }
+
+    const int row = firstPromptRow(group) + static_cast<int>(position);
+    const bool isPlain = m_Store.groupSpec(group).isEmpty();
+    return createIndex(row, column, isPlain ? childrenOfBase(m_Store.groupBase(group)) : childrenOfGroup(group));
+}
+
+void PromptTreeModel::emitPromptChanged(const PromptStore::PromptId prompt)
+{
+    const QModelIndex first = promptIndex(prompt, 0);
+    if (first.isValid()) {
+        emit dataChanged(first, promptIndex(prompt, HPB::PTColumnCount - 1));
+    }
+}
+
+/**
+ * @brief Notifies views that the CID or selection of prompts changed.
+ *
+ * Large batches emit one signal per group, spanning its changed rows, instead
+ * of one per prompt.
+ */
+void PromptTreeModel::emitPromptsChanged(const QList<PromptStore::PromptId>& prompts)
+{
+    if (prompts.size() <= maxRowSignals) {
+        for (const PromptId prompt : prompts) {
+            emitPromptChanged(prompt);
+        }
+        return;
+    }
+
+    QHash<GroupId, QPair<int, int>> rowsByGroup;
+    for (const PromptId prompt : prompts) {
+        const QModelIndex index = promptIndex(prompt, 0);
+        if (!index.isValid()) {
+            continue;
+        }
+        const GroupId group = m_Store.promptGroup(prompt);
+        const auto it = rowsByGroup.find(group);
+        if (it == rowsByGroup.end()) {
+            rowsByGroup.insert(group, { index.row(), index.row() });
+        }
+        else {
+            it->first = std::min(it->first, index.row());
+            it->second = std::max(it->second, index.row());
+        }
+    }
+
+    for (const auto [group, rows] : rowsByGroup.asKeyValueRange()) {
+        const bool isPlain = m_Store.groupSpec(group).isEmpty();
+        const quintptr parent = isPlain ? childrenOfBase(m_Store.groupBase(group)) : childrenOfGroup(group);
+        emit dataChanged(createIndex(rows.first, 0, parent), createIndex(rows.second, HPB::PTColumnCount - 1, parent));
+    }
+}
+
+/**
+ * @brief Recomputes the shown children of every node from the store and the CID filter.
+ *
+ * Removed nodes keep their shown children, so that restoring them needs no
+ * further lookups. A filter on a CID nobody has shows nothing.
+ */
+void PromptTreeModel::rebuild()
+{
+    m_Bases.clear();
+    m_Groups = QList<QList<GroupId>>(m_Store.baseCount());
+    m_Prompts = QList<QList<PromptId>>(m_Store.groupCount());
+
+    if (m_CidFilter && *m_CidFilter > 0) {
+        // only the prompts holding the CID are visited, through the store's CID index
+        for (const PromptId prompt : m_Store.cidPrompts(*m_CidFilter)) {
+            m_Prompts[m_Store.promptGroup(prompt)].push_back(prompt);
+        }
+        for (QList<PromptId>& prompts : m_Prompts) {
+            std::ranges::sort(prompts);
+        }
+    }
+    else if (!m_CidFilter || *m_CidFilter == 0) {
+        for (GroupId group = 0; group < m_Store.groupCount(); ++group) {
+            for (const PromptId prompt : m_Store.prompts(group)) {
+                if (!m_Store.isRemoved({ Node::Prompt, prompt }) && accepts(prompt)) {
+                    m_Prompts[group].push_back(prompt);
+                }
+            }
+        }
+    }
+
+    for (BaseId base = 0; base < m_Store.baseCount(); ++base) {
+        for (const GroupId group : m_Store.groups(base)) {
+            if (!m_Store.isRemoved({ Node::Group, group }) && (!m_CidFilter || !m_Prompts.at(group).isEmpty())) {
+                m_Groups[base].push_back(group);
+            }
+        }
+        if (!m_Store.isRemoved({ Node::Base, base }) && (!m_CidFilter || hasShownChildren(base))) {
+            m_Bases.push_back(base);
+        }
+    }
+}
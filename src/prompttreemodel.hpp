@@ -0,0 +1,98 @@
+#pragma once
+
+#include <optional>
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QModelIndex>
+#include <QString>
+#include <QVariant>
+
+#include "promptstore.hpp"
+
+/**
+ * @brief Tree model over the prompts of a PromptStore.
+ *
+ * Dataset bases are the top-level rows; their children are the (sub)datasets
+ * with a specification, followed by the prompts of the dataset without one.
+ * Nothing is allocated per row: indices carry the id of their parent node, and
+ * display data is read from the store when the view asks for it, i.e. only for
+ * the rows that are visible.
+ *
+ * The model keeps, for every node, the ids of its children that are shown. The
+ * lists are subsequences of the store's insertion order, so a node is found or
+ * put back with a binary search. An optional CID filter only shows the prompts
+ * with that CID, and the datasets that contain some of them.
+ */
+class PromptTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    using Node = PromptStore::Node;
+
+    /**
+     * @brief The id of a prompt to be added and the position of its instance in the task.
+     */
+    struct NewPrompt
+    {
+        QString id;
+        quint32 instance = 0;
+    };
+
+    explicit PromptTreeModel(QObject* parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    const PromptStore& store() const;
+
+    Node node(const QModelIndex& index) const;
+    PromptStore::PromptId prompt(const QModelIndex& index) const;
+    QList<PromptStore::PromptId> prompts(const QModelIndexList& indexes) const;
+
+    void addPrompts(const QString& datasetBase, const QString& datasetSpec, const PromptStore::Task& task, const QList<NewPrompt>& prompts);
+    void setCid(const QList<PromptStore::PromptId>& prompts, const QString& cid);
+    void setSelected(const QList<PromptStore::PromptId>& prompts, bool selected);
+    void removeNode(Node node);
+    bool restoreNode(Node node);
+    void removeNodes(const QList<Node>& nodes);
+    QList<Node> restoreNodes(const QList<Node>& nodes);
+    void clear();
+
+    void setCidFilter(const QString& cid);
+    void clearCidFilter();
+
+signals:
+    /**
+     * @brief Emitted when prompts get or lose a CID, or are removed or restored.
+     */
+    void cidsChanged();
+
+private:
+    // internal ids of indices: 0 for top-level rows, 2 * base + 1 under a base, 2 * group + 2 under a group
+    static quintptr childrenOfBase(PromptStore::BaseId base);
+    static quintptr childrenOfGroup(PromptStore::GroupId group);
+
+    bool accepts(PromptStore::PromptId prompt) const;
+    bool hasShownChildren(PromptStore::BaseId base) const;
+    bool isShown(PromptStore::GroupId group) const;
+    QModelIndex baseIndex(PromptStore::BaseId base) const;
+    QModelIndex groupIndex(PromptStore::GroupId group) const;
+    int firstPromptRow(PromptStore::GroupId group) const;
+    QModelIndex promptIndex(PromptStore::PromptId prompt, int column) const;
+    void emitPromptChanged(PromptStore::PromptId prompt);
+    void emitPromptsChanged(const QList<PromptStore::PromptId>& prompts);
+    void rebuild();
+
+    PromptStore m_Store;
+    std::optional<qint32> m_CidFilter;
+
+    QList<PromptStore::BaseId> m_Bases;
+    QList<QList<PromptStore::GroupId>> m_Groups;    // indexed by base
+    QList<QList<PromptStore::PromptId>> m_Prompts;  // indexed by group
+};
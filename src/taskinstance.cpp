@@ -0,0 +1,36 @@
+#include "taskinstance.hpp"
+
+#include <QJsonArray>
+
+/**
+ * @brief Extracts the displayed and searched fields from a HELM instance object.
+ *
+ * @param obj One element of the array stored in an `instances.json` file.
+ * @return TaskInstance The extracted instance.
+ */
+TaskInstance TaskInstance::fromJson(const QJsonObject& obj)
+{
+    TaskInstance instance;
+
+    instance.id = obj["id"].toString();
+    instance.input = obj["input"].toObject()["text"].toString();
+    instance.hasSubSplit = obj.contains("sub_split");
+    if (instance.hasSubSplit) {
+        instance.subSplit = obj["sub_split"].toString();
+    }
+    instance.isPerturbed = obj.contains("perturbation");
+
+    const QJsonArray references = obj["references"].toArray();
+    instance.references.reserve(references.size());
+    for (auto&& value : references) {
+        const QJsonObject reference = value.toObject();
+        InstanceReference ref;
+        ref.text = reference["output"].toObject()["text"].toString();
+        for (auto&& tag : reference["tags"].toArray()) {
+            ref.tags.push_back(tag.toString());
+        }
+        instance.references.push_back(std::move(ref));
+    }
+
+    return instance;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+struct InstanceReference {
+    QString text;
+    QStringList tags;
+};
+
+/**
+ * @brief The subset of a HELM instance that the browser displays and searches.
+ */
+struct TaskInstance {
+    quint32 index = 0;  // position in the task's instances.json, set by the readers
+    QString id;
+    QString input;
+    QString subSplit;
+    bool hasSubSplit = false;
+    bool isPerturbed = false;
+    QList<InstanceReference> references;
+
+    static TaskInstance fromJson(const QJsonObject& obj);
+};
@@ -0,0 +1,211 @@
+#include "trace.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+namespace {
+    // a thread drops the per-item spans past this count, so that a trace of a large search stays bounded
+    constexpr qsizetype maxPerItemEventsPerThread = qsizetype(1) << 20;
+
+    struct Event {
+        const char* name;
+        QString detail;
+        qint64 start;
+        qint64 duration;
+    };
+
+    /**
+     * @brief The spans of a thread. Buffers outlive their threads, and are reused by later traces.
+     */
+    struct ThreadEvents {
+        QMutex mutex;
+        int id = 0;
+        QString name;
+        QList<Event> events;
+        qsizetype perItemEvents = 0;
+        qint64 dropped = 0;
+    };
+
+    struct TraceState {
+        QMutex mutex;
+        QString fileName;
+        QElapsedTimer clock;
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+    };
+
+    TraceState& state()
+    {
+        static TraceState traceState;
+        return traceState;
+    }
+
+    thread_local ThreadEvents* threadEvents = nullptr;
+
+    ThreadEvents* registerThread()
+    {
+        TraceState& trace = state();
+        const QMutexLocker locker(&trace.mutex);
+
+        auto events = std::make_unique<ThreadEvents>();
+        events->id = static_cast<int>(trace.threads.size()) + 1;
+        const QCoreApplication* app = QCoreApplication::instance();
+        events->name = app != nullptr && QThread::currentThread() == app->thread() ? QString("main") : QString("worker %1").arg(events->id);
+        threadEvents = events.get();
+        trace.threads.push_back(std::move(events));
+        return threadEvents;
+    }
+
+    QByteArray traceEvent(const QJsonObject& event)
+    {
+        return QJsonDocument(event).toJson(QJsonDocument::Compact);
+    }
+} // namespace
+
+/*********
+ * Trace *
+ *********/
+
+/**
+ * @brief Starts recording spans, to be written to the given file by stop().
+ *
+ * @param fileName The trace file; empty to leave tracing off.
+ * @return bool True if tracing is on.
+ */
+bool Trace::start(const QString& fileName)
+{
+    if (fileName.isEmpty() || isEnabled()) {
+        return isEnabled();
+    }
+
+    TraceState& trace = state();
+    const QMutexLocker locker(&trace.mutex);
+    for (const auto& events : trace.threads) {
+        const QMutexLocker threadLocker(&events->mutex);
+        events->events.clear();
+        events->perItemEvents = 0;
+        events->dropped = 0;
+    }
+    trace.fileName = fileName;
+    trace.clock.start();
+    m_Enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Stops recording and writes the trace in the Chrome trace event format.
+ *
+ * Every thread gets its own timeline; spans are complete events, with times in
+ * microseconds since start().
+ *
+ * @return bool False if tracing was off or the file could not be written.
+ */
+bool Trace::stop()
+{
+    if (!m_Enabled.exchange(false)) {
+        return false;
+    }
+
+    TraceState& trace = state();
+    const QMutexLocker locker(&trace.mutex);
+
+    QSaveFile file(trace.fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        std::fprintf(stderr, "Failed to write the trace to %s: %s\n", qPrintable(trace.fileName), qPrintable(file.errorString()));
+        return false;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray buffer = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    const auto append = [&](const QJsonObject& event) {
+        if (!first) {
+            buffer += ",\n";
+        }
+        first = false;
+        buffer += traceEvent(event);
+        if (buffer.size() >= 1024 * 1024) {
+            file.write(buffer);
+            buffer.resize(0);
+        }
+    };
+
+    for (const auto& events : trace.threads) {
+        const QMutexLocker threadLocker(&events->mutex);
+        if (events->events.isEmpty() && events->dropped == 0) {
+            continue;
+        }
+
+        QJsonObject threadArgs { { "name", events->name } };
+        if (events->dropped > 0) {
+            threadArgs["dropped_spans"] = events->dropped;
+        }
+        append({ { "name", "thread_name" }, { "ph", "M" }, { "pid", pid }, { "tid", events->id }, { "args", threadArgs } });
+
+        for (const Event& event : std::as_const(events->events)) {
+            QJsonObject span { { "name", QString::fromLatin1(event.name) },
+                               { "cat", "hpb" },
+                               { "ph", "X" },
+                               { "ts", event.start / 1000.0 },
+                               { "dur", event.duration / 1000.0 },
+                               { "pid", pid },
+                               { "tid", events->id } };
+            if (!event.detail.isEmpty()) {
+                span["args"] = QJsonObject { { "detail", event.detail } };
+            }
+            append(span);
+        }
+        events->events.clear();
+    }
+
+    buffer += "\n]}\n";
+    file.write(buffer);
+    return file.commit();
+}
+
+qint64 Trace::now()
+{
+    return state().clock.nsecsElapsed();
+}
+
+void Trace::record(const char* name, const QString& detail, const qint64 start, const qint64 end, const bool perItem)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    ThreadEvents* events = threadEvents != nullptr ? threadEvents : registerThread();
+    const QMutexLocker locker(&events->mutex);
+    if (perItem) {
+        if (events->perItemEvents >= maxPerItemEventsPerThread) {
+            ++events->dropped;
+            return;
+        }
+        ++events->perItemEvents;
+    }
+    events->events.push_back({ name, detail, start, end - start });
+}
+
+/****************
+ * TraceSession *
+ ****************/
+
+TraceSession::TraceSession(const QString& fileName)
+{
+    Trace::start(fileName);
+}
+
+TraceSession::~TraceSession()
+{
+    Trace::stop();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Records scoped spans and writes them as a Chrome trace, to be opened in Perfetto or chrome://tracing.
+ *
+ * Tracing is off unless start() was given a file name; the GUI and hpb-cli take
+ * it from the HPB_TRACE environment variable. While it is off, a TraceSpan costs
+ * one relaxed atomic load. While it is on, every thread appends its spans to its
+ * own buffer, so threads only contend when the trace is written.
+ */
+class Trace
+{
+public:
+    static bool start(const QString& fileName);
+    static bool stop();
+
+    static bool isEnabled() { return m_Enabled.load(std::memory_order_relaxed); }
+
+private:
+    friend class TraceSpan;
+
+    static qint64 now();
+    static void record(const char* name, const QString& detail, qint64 start, qint64 end, bool perItem);
+
+    inline static std::atomic<bool> m_Enabled = false;
+};
+
+/**
+ * @brief A span of the trace, from its construction to its destruction.
+ *
+ * The name must be a string literal; it is stored as a pointer. The optional
+ * detail, e.g. a dataset name, is shown with the span. Spans taken once per
+ * prompt or instance are marked PerItem: a thread only keeps a bounded number
+ * of those, while its other spans are always kept.
+ */
+class TraceSpan
+{
+public:
+    enum Granularity {
+        Coarse,
+        PerItem,
+    };
+
+    explicit TraceSpan(const char* name, const Granularity granularity = Coarse)
+        : m_Name(Trace::isEnabled() ? name : nullptr)
+        , m_Start(m_Name != nullptr ? Trace::now() : 0)
+        , m_PerItem(granularity == PerItem)
+    {}
+
+    TraceSpan(const char* name, const QString& detail)
+        : m_Name(Trace::isEnabled() ? name : nullptr)
+        , m_Detail(m_Name != nullptr ? detail : QString())
+        , m_Start(m_Name != nullptr ? Trace::now() : 0)
+    {}
+
+    ~TraceSpan()
+    {
+        if (m_Name != nullptr) {
+            Trace::record(m_Name, m_Detail, m_Start, Trace::now(), m_PerItem);
+        }
+    }
+
+    Q_DISABLE_COPY_MOVE(TraceSpan)
+
+private:
+    const char* m_Name;
+    QString m_Detail;
+    qint64 m_Start;
+    bool m_PerItem = false;
+};
+
+/**
+ * @brief Traces the lifetime of a scope, e.g. of main(), to the given file; does nothing if it is empty.
+ */
+class TraceSession
+{
+public:
+    explicit TraceSession(const QString& fileName);
+    ~TraceSession();
+
+    Q_DISABLE_COPY_MOVE(TraceSession)
+};
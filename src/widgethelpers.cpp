@@ -0,0 +1,136 @@
+#include "widgethelpers.hpp"
+
+#include <QCheckBox>
+#include <QMessageBox>
+#include <QString>
+#include <QTimer>
+
+#include "helperfunctions.hpp"
+
+/*****************
+ * QMessageBoxes *
+ *****************/
+
+/**
+ * @brief Displays a message box with Yes/No options and an optional "Don't show again" checkbox.
+ *
+ * @param text The main text of the message box.
+ * @param informativeText Additional information displayed in the message box.
+ * @param dontShowAgain Reference to a boolean variable indicating if the "Don't show again" checkbox was checked.
+ * @return int The button pressed by the user (QMessageBox::Yes or QMessageBox::No).
+ */
+int Ask(const QString& text, const QString& informativeText, bool& dontShowAgain) {
+    QMessageBox msg;
+    msg.setText(text);
+    msg.setInformativeText(informativeText);
+    msg.setIcon(QMessageBox::Information);
+    msg.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    auto *checkbox = new QCheckBox();
+    checkbox->setCheckState(Qt::Unchecked);
+    checkbox->setText("Don't show this again");
+    msg.setCheckBox(checkbox);
+    const int result = msg.exec();
+    dontShowAgain = checkbox->checkState();
+    return result;
+}
+
+/**
+ * @brief Displays a popup message box that automatically closes after 1.5 seconds.
+ *
+ * @param message The message to be displayed in the popup.
+ */
+void PopUp(const QString& message)
+{
+    QMessageBox msgBox;
+    msgBox.setText(message);
+    msgBox.setStandardButtons(QMessageBox::NoButton);
+    const int popupDuration = 1500;
+    QTimer::singleShot(popupDuration, &msgBox, &QMessageBox::accept);
+    msgBox.exec();
+}
+
+/**
+ * @brief Displays a warning message box.
+ *
+ * @param message The warning message to be displayed.
+ */
+void Warn(const QString& message)
+{
+    QMessageBox msg;
+    msg.setText(message);
+    msg.setIcon(QMessageBox::Warning);
+    msg.exec();
+}
+
+
+/**************************************
+ * Dataset tree convenience functions *
+ **************************************/
+
+/**
+ * @brief Retrieves the list of selected datasets from a QTreeWidget.
+ *
+ * @param tree The QTreeWidget representing the dataset structure.
+ * @return QStringList The list of selected dataset names.
+ */
+QStringList getSelectedDatasetNames(const QTreeWidget* tree)
+{
+    QStringList selectedDatasets;
+
+    const int topLevelDatasetCount = tree->topLevelItemCount();
+
+    // process top level datasets
+    for (int i : _range(0, topLevelDatasetCount)) {
+        QTreeWidgetItem* parent = tree->topLevelItem(i);
+        QString const parentName = parent->data(0, Qt::DisplayRole).toString();
+
+        if (parent->checkState(0) == Qt::Unchecked) {
+            continue;
+        }
+
+        // if dataset has no sub-datasets, do nothing if already in tree, add it if not
+        if (parent->childCount() == 0) {
+            selectedDatasets.push_back(parentName);
+            continue;
+        }
+
+        // dataset has sub-datasets
+        // process each sub-dataset
+        const int childCount = parent->childCount();
+        for (int j : _range(0, childCount)) {
+            QTreeWidgetItem* child = parent->child(j);
+            QString const childName = child->data(0, Qt::DisplayRole).toString();
+
+            // if sub-dataset is unchecked, delete it from prompt tree if present, ignore it if not
+            if (child->checkState(0) == Qt::Unchecked) {
+                continue;
+            }
+
+            // add it if not in tree
+            selectedDatasets.push_back(childName);
+        }
+    }
+    return selectedDatasets;
+}
+
+/**
+ * @brief Transforms all dataset entries in a QTreeWidget using a given transformation function.
+ *
+ * @param datasetTree The QTreeWidget representing datasets.
+ * @param transformation The transformation function to apply.
+ */
+void transformDatasetTree(QTreeWidget* datasetTree, const std::function<void(QTreeWidgetItem*)>& transformation)
+{
+    const int datasetCount = datasetTree->topLevelItemCount();
+    for (int i : _range(0, datasetCount)) {
+        QTreeWidgetItem* dataset = datasetTree->topLevelItem(i);
+        if (dataset->childCount() == 0) {
+            transformation(dataset);
+            continue;
+        }
+        const int specificationCount = dataset->childCount();
+        for (int j : _range(0, specificationCount)) {
+            transformation(dataset->child(j));
+        }
+    }
+}
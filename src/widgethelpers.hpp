@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+
+#include <QString>
+#include <QStringList>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+/*****************
+ * QMessageBoxes *
+ *****************/
+
+int Ask(const QString& text, const QString& informativeText, bool& dontShowAgain);
+void PopUp(const QString& message);
+void Warn(const QString& message);
+
+/**************************************
+ * Dataset tree convenience functions *
+ **************************************/
+
+QStringList getSelectedDatasetNames(const QTreeWidget* tree);
+void transformDatasetTree(QTreeWidget* datasetTree, const std::function<void(QTreeWidgetItem*)>& transformation);